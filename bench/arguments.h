@@ -0,0 +1,47 @@
+#pragma once
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Calls handler(key, value) for each command line argument of the form --key=value. The value is empty when
+// the argument has no '=' and is null terminated, because it ends with the argument.
+template <typename Handler>
+void parse_arguments(int argc, char* argv[], Handler&& handler) {
+  for (auto i = 1; i < argc; ++i) {
+    const std::string_view arg(argv[i]);
+    const auto pos = arg.find('=');
+    const auto key = arg.substr(0, pos);
+    const auto value = pos == std::string_view::npos ? std::string_view() : arg.substr(pos + 1);
+    handler(key, value);
+  }
+}
+
+// Application arguments of a benchmark. The defaults are placed before the command line arguments, so that
+// later arguments override them.
+class forwarded_arguments {
+public:
+  forwarded_arguments(int argc, char* argv[], std::initializer_list<const char*> defaults) :
+    defaults_(defaults.begin(), defaults.end()) {
+    argv_.push_back(argv[0]);
+    for (auto& argument : defaults_) {
+      argv_.push_back(argument.data());
+    }
+    argv_.insert(argv_.end(), argv + 1, argv + argc);
+  }
+
+  forwarded_arguments(forwarded_arguments&& other) = delete;
+  forwarded_arguments& operator=(forwarded_arguments&& other) = delete;
+
+  int argc() const noexcept {
+    return static_cast<int>(argv_.size());
+  }
+
+  char** argv() noexcept {
+    return argv_.data();
+  }
+
+private:
+  std::vector<std::string> defaults_;
+  std::vector<char*> argv_;
+};
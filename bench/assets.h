@@ -0,0 +1,102 @@
+#pragma once
+#include <context.h>
+#include <gl/arrays.h>
+#include <gl/ktx.h>
+#include <gl/program.h>
+#include <gl/textures.h>
+#include <filesystem>
+#include <string_view>
+
+// Compressed sample textures loaded from KTX containers.
+//
+// The ETC2 texture array in array.ktx2 (2 layers, 16x16, full mip chain) and the ETC2 cube map in cube.ktx
+// (4x4, 3 levels, key/value metadata) are drawn as two quads at the bottom of the frame. The left quad shows
+// both layers of the array side by side and the right quad shows the six faces of the cube map.
+class assets {
+public:
+  // Loads the textures from the directory. An empty directory disables the assets.
+  void create(context& context, const std::filesystem::path& directory) {
+    if (directory.empty()) {
+      return;
+    }
+    const gl::ktx array(directory / "array.ktx2");
+    const gl::ktx cube(directory / "cube.ktx");
+    array_ = array.create();
+    cube_ = cube.create();
+    levels_ = array.levels() + cube.levels();
+
+    // Both quads are generated from the vertex id.
+    const std::string_view vert =
+      "#version 300 es\n"
+      "precision highp float;\n"
+      "flat out int vert_quad;\n"
+      "out vec2 vert_uv;\n"
+      "void main() {\n"
+      "  const vec2 corners[6] = vec2[6](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),\n"
+      "    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));\n"
+      "  vert_quad = gl_VertexID / 6;\n"
+      "  vert_uv = corners[gl_VertexID % 6];\n"
+      "  vec2 origin = vert_quad == 0 ? vec2(-0.95, -0.95) : vec2(0.15, -0.95);\n"
+      "  gl_Position = vec4(origin + vert_uv * vec2(0.8, 0.4), -1.0, 1.0);\n"
+      "}";
+
+    const std::string_view frag =
+      "#version 300 es\n"
+      "precision mediump float;\n"
+      "uniform mediump sampler2DArray layers;\n"
+      "uniform mediump samplerCube faces;\n"
+      "flat in int vert_quad;\n"
+      "in vec2 vert_uv;\n"
+      "out vec4 frag_color;\n"
+      "void main() {\n"
+      "  if (vert_quad == 0) {\n"
+      "    vec2 cell = vert_uv * vec2(2.0, 1.0);\n"
+      "    frag_color = texture(layers, vec3(fract(cell), floor(cell.x)));\n"
+      "    return;\n"
+      "  }\n"
+      "  const vec3 axes[6] = vec3[6](vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0),\n"
+      "    vec3(-1.0, 0.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, -1.0));\n"
+      "  vec2 cell = vert_uv * vec2(3.0, 1.0);\n"
+      "  int face = int(cell.x) + 3 * int(vert_uv.y * 2.0);\n"
+      "  vec2 st = vec2(fract(cell.x), fract(vert_uv.y * 2.0)) * 1.8 - 0.9;\n"
+      "  frag_color = texture(faces, axes[face] + st.x * axes[(face + 1) % 6] + st.y * axes[(face + 2) % 6]);\n"
+      "}";
+
+    program_ = gl::program(vert, frag, context.shader_cache());
+    context.state().use_program(program_);
+    glUniform1i(program_.uniform("layers"), 0);
+    glUniform1i(program_.uniform("faces"), 1);
+    vao_ = gl::arrays(1);
+  }
+
+  void destroy() {
+    program_ = {};
+    vao_ = {};
+    array_ = {};
+    cube_ = {};
+  }
+
+  void render(context& context) {
+    if (!program_) {
+      return;
+    }
+    context.state().bind_framebuffer(GL_FRAMEBUFFER, context.framebuffer());
+    context.state().use_program(program_);
+    context.state().bind_vertex_array(vao_[0]);
+    context.state().bind_texture(0, GL_TEXTURE_2D_ARRAY, array_[0]);
+    context.state().bind_texture(1, GL_TEXTURE_CUBE_MAP, cube_[0]);
+    glDrawArrays(GL_TRIANGLES, 0, 12);
+  }
+
+  // Number of mip levels uploaded from both containers.
+  GLsizei levels() const noexcept {
+    return levels_;
+  }
+
+private:
+  gl::program program_;
+  gl::arrays vao_;
+  gl::textures array_;
+  gl::textures cube_;
+  GLsizei levels_ = 0;
+};
@@ -0,0 +1,380 @@
+#include <capture.h>
+#include <client.h>
+#include <config.h>
+#include <streamer.h>
+#include "arguments.h"
+#include "assets.h"
+#include "objects.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Headless benchmark.
+//
+// Renders the test scene offscreen for a fixed number of frames without frame pacing, writes the results as
+// JSON and compares the last frame to a reference image. Application options are forwarded to the scene.
+//
+// --output=FILE      write the JSON report to FILE instead of stdout
+// --golden=FILE      compare the last frame to the binary PPM reference image in FILE
+// --update-golden    write the last frame to the reference image instead of comparing it
+// --tolerance=N      maximum per-channel difference of matching pixels (default 16)
+// --threshold=F      fraction of pixels allowed to exceed the tolerance (default 0.001)
+// --views=N          render the scene into N additional half-size offscreen views (default 1)
+// --objects=N        draw N additional objects through the sorted draw queue (default 1024)
+// --assets=DIR       load the sample KTX textures from DIR, none when empty (default bench)
+
+namespace {
+
+struct arguments {
+  std::string output;
+  std::string golden;
+  bool update = false;
+  int tolerance = 16;
+  double threshold = 0.001;
+  int views = 1;
+  std::size_t objects = 1024;
+  std::string assets = "bench";
+
+  arguments(int argc, char* argv[]) {
+    parse_arguments(argc, argv, [this](std::string_view key, std::string_view value) {
+      if (key == "--output") {
+        output = value;
+      } else if (key == "--golden") {
+        golden = value;
+      } else if (key == "--update-golden") {
+        update = true;
+      } else if (key == "--tolerance") {
+        tolerance = std::max(0, std::atoi(value.data()));
+      } else if (key == "--threshold") {
+        threshold = std::max(0.0, std::strtod(value.data(), nullptr));
+      } else if (key == "--objects") {
+        objects = std::strtoull(value.data(), nullptr, 10);
+      } else if (key == "--assets") {
+        assets = value;
+      } else if (key == "--views") {
+        views = std::max(0, std::atoi(value.data()));
+      }
+    });
+  }
+};
+
+struct comparison {
+  bool compared = false;
+  bool passed = false;
+  std::string error;
+  std::size_t mismatched = 0;
+  int difference = 0;
+};
+
+class benchmark : public client {
+public:
+  using clock = std::chrono::steady_clock;
+
+  using client::client;
+
+  // Sets the number of offscreen views created with the scene.
+  void views(int count) noexcept {
+    views_ = count;
+  }
+
+  // Sets the number of objects drawn through the draw queue.
+  void objects(std::size_t count) noexcept {
+    count_ = count;
+  }
+
+  // Sets the directory of the sample textures.
+  void assets(std::string directory) {
+    directory_ = std::move(directory);
+  }
+
+  void create(GLsizei cx, GLsizei cy, GLint dpi) override {
+    client::create(cx, cy, dpi);
+    objects_.create(*this, count_);
+    assets_.create(*this, directory_);
+    for (auto i = 0; i < views_; i++) {
+      create_view(cx / 2, cy / 2);
+    }
+  }
+
+  void resize(GLsizei cx, GLsizei cy, GLint dpi) override {
+    client::resize(cx, cy, dpi);
+    objects_.resize(cx, cy);
+  }
+
+  void destroy() override {
+    assets_.destroy();
+    objects_.destroy();
+    client::destroy();
+  }
+
+  void render() override {
+    client::render();
+    objects_.render(*this);
+    assets_.render(*this);
+  }
+
+  // Renders the scene into the view. The main frame is compared to the reference image after the views of the
+  // previous frames were rendered, which checks that the surface, framebuffer and viewport are restored.
+  void render_view(view& view) override {
+    render();
+    view_frames_++;
+  }
+
+  void on_render() override {
+    // Read back the last frame.
+    if (frames_ + 1 == settings().frames) {
+      capture_frames([this](const capture::frame& frame) { last_ = frame; });
+    }
+    const auto start = clock::now();
+    if (!frames_) {
+      start_ = start;
+      times_.reserve(static_cast<std::size_t>(settings().frames));
+    }
+    client::on_render();
+    stop_ = clock::now();
+    times_.push_back(std::chrono::duration<float, std::milli>(stop_ - start).count());
+    frames_++;
+  }
+
+  std::uint64_t frames() const noexcept {
+    return frames_;
+  }
+
+  // Returns the objects drawn through the draw queue.
+  const ::objects& scene() const noexcept {
+    return objects_;
+  }
+
+  // Returns the sample textures.
+  const ::assets& textures() const noexcept {
+    return assets_;
+  }
+
+  // Number of views rendered over all frames.
+  std::uint64_t view_frames() const noexcept {
+    return view_frames_;
+  }
+
+  double seconds() const noexcept {
+    return std::chrono::duration<double>(stop_ - start_).count();
+  }
+
+  // Frame times in milliseconds of all rendered frames.
+  const std::vector<float>& times() const noexcept {
+    return times_;
+  }
+
+  // Valid after run() returned.
+  const capture::frame& last() const noexcept {
+    return last_;
+  }
+
+private:
+  int views_ = 0;
+  std::size_t count_ = 0;
+  ::objects objects_;
+  std::string directory_;
+  ::assets assets_;
+  std::uint64_t frames_ = 0;
+  std::uint64_t view_frames_ = 0;
+  clock::time_point start_;
+  clock::time_point stop_;
+  std::vector<float> times_;
+  capture::frame last_;
+};
+
+void write_ppm(const std::string& path, const capture::frame& frame) {
+  std::ofstream file(path, std::ios::binary);
+  file << "P6\n" << frame.cx << ' ' << frame.cy << "\n255\n";
+  for (std::size_t i = 0; i < frame.pixels.size(); i += 4) {
+    file.write(reinterpret_cast<const char*>(frame.pixels.data() + i), 3);
+  }
+  if (!file) {
+    throw gl::runtime_error("Could not write reference image: " + path);
+  }
+}
+
+comparison compare(const arguments& args, const capture::frame& frame) {
+  comparison result;
+  if (args.golden.empty()) {
+    return result;
+  }
+  result.compared = true;
+  try {
+    if (frame.pixels.empty()) {
+      throw gl::runtime_error("The last frame was not captured.");
+    }
+    if (args.update) {
+      write_ppm(args.golden, frame);
+      result.passed = true;
+      return result;
+    }
+    const auto golden = streamer::read_ppm(args.golden);
+    if (golden.cx != frame.cx || golden.cy != frame.cy) {
+      throw gl::runtime_error("The reference image is " + std::to_string(golden.cx) + "x" +
+        std::to_string(golden.cy) + " but the frame is " + std::to_string(frame.cx) + "x" + std::to_string(frame.cy) + ".");
+    }
+
+    // Compare color channels only, the reference image has no alpha.
+    for (std::size_t i = 0; i < frame.pixels.size(); i += 4) {
+      auto difference = 0;
+      for (std::size_t c = 0; c < 3; c++) {
+        difference = std::max(difference, std::abs(frame.pixels[i + c] - golden.data[i + c]));
+      }
+      result.difference = std::max(result.difference, difference);
+      if (difference > args.tolerance) {
+        result.mismatched++;
+      }
+    }
+    const auto pixels = static_cast<double>(frame.cx) * frame.cy;
+    result.passed = static_cast<double>(result.mismatched) <= args.threshold * pixels;
+  }
+  catch (const std::exception& e) {
+    result.error = e.what();
+  }
+  return result;
+}
+
+std::string escape(std::string_view text) {
+  std::string result;
+  for (const auto c : text) {
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+      result.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      result.push_back(' ');
+    } else {
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
+float percentile(std::vector<float>& values, double p) {
+  if (values.empty()) {
+    return 0.0f;
+  }
+  const auto index = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+  std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+  return values[index];
+}
+
+// Largest relative difference allowed between the vector and scalar transform paths.
+constexpr float transform_tolerance = 1e-5f;
+
+void report(std::FILE* file, benchmark& benchmark, const arguments& args, const comparison& comparison,
+  float transform_difference) {
+  const auto frames = benchmark.frames();
+  const auto seconds = benchmark.seconds();
+  std::fprintf(file, "{\n");
+  std::fprintf(file, "  \"backend\": \"%s\",\n", escape(benchmark.backend()).data());
+  std::fprintf(file, "  \"frames\": %llu,\n", static_cast<unsigned long long>(frames));
+  std::fprintf(file, "  \"size\": [%d, %d],\n", benchmark.settings().cx, benchmark.settings().cy);
+  std::fprintf(file, "  \"samples\": %d,\n", benchmark.settings().samples);
+  std::fprintf(file, "  \"seconds\": %.6f,\n", seconds);
+  std::fprintf(file, "  \"fps\": %.3f,\n", seconds > 0.0 ? static_cast<double>(frames) / seconds : 0.0);
+  const auto& objects = benchmark.scene();
+  const auto renders = std::max<std::uint64_t>(frames + benchmark.view_frames(), 1);
+  std::fprintf(file, "  \"queue\": {\"objects\": %zu, \"packets\": %llu, \"draws\": %llu, "
+    "\"packets_per_render\": %.1f, \"draws_per_render\": %.1f},\n", objects.size(),
+    static_cast<unsigned long long>(objects.packets()), static_cast<unsigned long long>(objects.draws()),
+    static_cast<double>(objects.packets()) / renders, static_cast<double>(objects.draws()) / renders);
+  std::fprintf(file, "  \"transforms\": {\"objects\": %zu, \"max_difference\": %g, \"passed\": %s},\n",
+    objects.size(), static_cast<double>(transform_difference),
+    transform_difference <= transform_tolerance ? "true" : "false");
+  std::fprintf(file, "  \"assets\": {\"directory\": \"%s\", \"levels\": %d},\n", escape(args.assets).data(),
+    benchmark.textures().levels());
+  std::fprintf(file, "  \"views\": {\"count\": %d, \"frames\": %llu},\n", args.views,
+    static_cast<unsigned long long>(benchmark.view_frames()));
+
+  // Frame time percentiles over the whole run. The profiler only keeps the most recent frames.
+  auto totals = benchmark.times();
+  std::fprintf(file, "  \"frame_ms\": {\"count\": %zu, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+    totals.size(), static_cast<double>(percentile(totals, 0.5)), static_cast<double>(percentile(totals, 0.9)),
+    static_cast<double>(percentile(totals, 0.99)), static_cast<double>(percentile(totals, 1.0)));
+
+  // Average timings over the profiler history of the stages that ran. GPU timings are -1 when timer queries are unavailable.
+  const auto summary = benchmark.profiling().report();
+  std::fprintf(file, "  \"stages\": {");
+  auto separator = "\n";
+  for (std::size_t i = 0; i < profiler::stages; i++) {
+    if (!summary.cpu[i].count) {
+      continue;
+    }
+    const auto gpu = summary.gpu[i].count ? static_cast<double>(summary.gpu[i].avg) : -1.0;
+    std::fprintf(file, "%s    \"%s\": {\"cpu_ms\": %.3f, \"gpu_ms\": %.3f, \"frames\": %zu}", separator,
+      profiler::name(static_cast<profiler::stage>(i)), static_cast<double>(summary.cpu[i].avg), gpu, summary.cpu[i].count);
+    separator = ",\n";
+  }
+  std::fprintf(file, "\n  },\n");
+
+  // State changes issued to and elided from the driver.
+  const auto& total = benchmark.state().total();
+  const auto tracked = std::max<std::uint64_t>(benchmark.state().frames(), 1);
+  std::fprintf(file, "  \"gl\": {\"calls\": %llu, \"elided\": %llu, \"calls_per_frame\": %.1f, \"elided_per_frame\": %.1f},\n",
+    static_cast<unsigned long long>(total.calls), static_cast<unsigned long long>(total.elided),
+    static_cast<double>(total.calls) / tracked, static_cast<double>(total.elided) / tracked);
+
+  // Reference image comparison.
+  if (!comparison.compared) {
+    std::fprintf(file, "  \"golden\": null\n");
+  } else {
+    std::fprintf(file, "  \"golden\": {\"path\": \"%s\", \"updated\": %s, \"passed\": %s, \"mismatched\": %zu, "
+      "\"max_difference\": %d, \"tolerance\": %d, \"threshold\": %g", escape(args.golden).data(),
+      args.update ? "true" : "false", comparison.passed ? "true" : "false", comparison.mismatched,
+      comparison.difference, args.tolerance, args.threshold);
+    if (!comparison.error.empty()) {
+      std::fprintf(file, ", \"error\": \"%s\"", escape(comparison.error).data());
+    }
+    std::fprintf(file, "}\n");
+  }
+  std::fprintf(file, "}\n");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  // Render a fixed number of frames as fast as possible. Later arguments override the defaults.
+  forwarded_arguments forwarded(argc, argv, { "--frames=300", "--size=256x256", "--pacing=uncapped" });
+  const arguments args(argc, argv);
+  benchmark benchmark(forwarded.argc(), forwarded.argv());
+  benchmark.views(args.views);
+  benchmark.objects(args.objects);
+  benchmark.assets(args.assets);
+  if (!benchmark.settings().frames) {
+    std::fprintf(stderr, "%s: the benchmark requires a frame limit\n", PROJECT);
+    return 1;
+  }
+  if (const auto result = benchmark.run()) {
+    return result;
+  }
+  const auto comparison = compare(args, benchmark.last());
+  const auto transform_difference = benchmark.scene().check();
+  auto file = stdout;
+  if (!args.output.empty()) {
+    file = std::fopen(args.output.data(), "wb");
+    if (!file) {
+      std::fprintf(stderr, "%s: could not open %s\n", PROJECT, args.output.data());
+      return 1;
+    }
+  }
+  report(file, benchmark, args, comparison, transform_difference);
+  if (file != stdout) {
+    std::fclose(file);
+  }
+  if (!comparison.error.empty()) {
+    std::fprintf(stderr, "%s: %s\n", PROJECT, comparison.error.data());
+  }
+  if (transform_difference > transform_tolerance) {
+    std::fprintf(stderr, "%s: the vector and scalar transforms differ by %g\n", PROJECT,
+      static_cast<double>(transform_difference));
+    return 2;
+  }
+  return comparison.compared && !comparison.passed ? 2 : 0;
+}
@@ -0,0 +1,264 @@
+#pragma once
+#include <client.h>
+#include <gl/commands.h>
+#include <gl/queue.h>
+#include <math/batch.h>
+#include <math/cull.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// Field of small spinning shapes drawn through the sorted draw queue.
+//
+// The objects are split into chunks whose matrices fill one uniform block. Every frame the matrices are
+// computed from the SoA transforms straight into the stream buffer and the visible objects of each chunk are
+// pushed as packets, which the queue of the chunk sorts by shape and depth and merges into one instanced draw
+// per shape. Chunks are recorded in parallel.
+class objects {
+public:
+  // Objects per chunk. A block of 256 matrices is the minimum uniform block size of OpenGL ES 3.0.
+  static constexpr std::size_t chunk = 256;
+
+  void create(context& context, std::size_t count) {
+    count_ = count;
+    if (!count_) {
+      return;
+    }
+    const std::string_view vert =
+      "#version 300 es\n"
+      "precision highp float;\n"
+      "in vec2 position;\n"
+      "in vec3 color;\n"
+      "in uint instance;\n"
+      "out vec3 vert_color;\n"
+      "layout(std140) uniform objects {\n"
+      "  mat4 transforms[256];\n"
+      "};\n"
+      "void main() {\n"
+      "  vert_color = color;\n"
+      "  gl_Position = transforms[instance] * vec4(position, 0.0, 1.0);\n"
+      "}";
+
+    const std::string_view frag =
+      "#version 300 es\n"
+      "precision mediump float;\n"
+      "in vec3 vert_color;\n"
+      "out vec4 frag_color;\n"
+      "void main() {\n"
+      "  frag_color = vec4(vert_color, 1.0);\n"
+      "}";
+
+    program_ = gl::program(vert, frag, context.shader_cache());
+    program_.block("objects", binding, block);
+    instance_ = program_.attribute("instance");
+
+    // A triangle and a quad share the vertex buffer. Each shape has its own vertex array and element buffer.
+    const vertex vertices[] = {
+      { {  0.0f,  1.0f }, { 1.0f, 1.0f, 0.0f, 1.0f } },
+      { {  1.0f, -1.0f }, { 1.0f, 0.0f, 1.0f, 1.0f } },
+      { { -1.0f, -1.0f }, { 0.0f, 1.0f, 1.0f, 1.0f } },
+      { {  1.0f,  1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+      { { -1.0f,  1.0f }, { 0.2f, 0.2f, 0.2f, 1.0f } },
+    };
+    const unsigned elements[][6] = {
+      { 0, 1, 2, 0, 0, 0 },
+      { 2, 1, 3, 2, 3, 4 },
+    };
+    vao_ = gl::arrays(shapes);
+    vbo_ = gl::buffers(1 + shapes);
+    context.state().bind_vertex_array(0);
+    context.state().bind_buffer(GL_ARRAY_BUFFER, vbo_[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    for (std::size_t i = 0; i < shapes; i++) {
+      context.state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, vbo_[1 + i]);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements[i]), elements[i], GL_STATIC_DRAW);
+      vao_.layout<vertex>(i, program_, vbo_[0], vbo_[1 + i]);
+    }
+
+    // Lay the objects out on a grid that extends past the sides, so that some of them are culled.
+    const auto columns = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count_))));
+    const auto spacing = 2.4f / static_cast<float>(columns);
+    transforms_.resize(count_);
+    bounds_.resize(count_);
+    phases_.resize(count_);
+    for (std::size_t i = 0; i < count_; i++) {
+      // Pseudo-random depth and phase.
+      const auto hash = static_cast<std::uint32_t>(i) * 2654435761U;
+      const auto x = -1.2f + (static_cast<float>(i % columns) + 0.5f) * spacing;
+      const auto y = -1.2f + (static_cast<float>(i / columns) + 0.5f) * spacing;
+      const auto z = static_cast<float>(hash >> 8) / static_cast<float>(1 << 24) * 1.8f - 0.9f;
+      const auto scale = spacing * 0.35f;
+      transforms_.set(i, { x, y, z }, {}, { scale, scale, 1.0f });
+      bounds_.set(i, { x, y, z }, scale * std::sqrt(2.0f));
+      phases_[i] = static_cast<float>(hash & 0xFF) / 256.0f * 6.2831853f;
+    }
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment_ = std::max<GLsizeiptr>(alignment, 16);
+    stride_ = (block + alignment_ - 1) / alignment_ * alignment_;
+  }
+
+  void resize(GLsizei cx, GLsizei cy) {
+    view_projection_ = math::mat4::scale({ static_cast<float>(cy) / static_cast<float>(cx), 1.0f, 1.0f });
+    frustum_ = math::frustum::extract(view_projection_);
+  }
+
+  void destroy() {
+    lists_.clear();
+    program_ = {};
+    vbo_ = {};
+    vao_ = {};
+  }
+
+  // Animates, culls and draws the objects into the framebuffer of the context. Each chunk is a task of the
+  // workers() that records into its own command list. The lists are replayed in chunk order.
+  void render(context& context) {
+    if (!count_) {
+      return;
+    }
+    const auto& visible = context.cull(frustum_, bounds_);
+
+    // Map the matrices of all chunks followed by the instance indices of the visible objects. Tasks only
+    // write to the mapping and record commands, so no OpenGL ES calls are made off this thread.
+    auto& stream = context.stream();
+    const auto chunks = (count_ + chunk - 1) / chunk;
+    const auto matrices = stride_ * static_cast<GLsizeiptr>(chunks);
+    const auto indices = static_cast<GLsizeiptr>(visible.size() * sizeof(GLuint));
+    const auto region = stream.map(matrices + std::max<GLsizeiptr>(indices, sizeof(GLuint)), alignment_);
+    const auto data = static_cast<std::byte*>(region.data);
+    const auto instances = reinterpret_cast<GLuint*>(data + matrices);
+
+    queues_.resize(chunks);
+    lists_.resize(chunks);
+    const GLuint buffer = stream;
+    const GLuint program = program_;
+    const GLuint framebuffer = context.framebuffer();
+    const auto angle = static_cast<float>(context.frame_number()) * 0.05f;
+    context.workers().run(chunks, [&](std::size_t i) {
+      const auto first = i * chunk;
+      const auto count = std::min(chunk, count_ - first);
+      auto& list = lists_[i];
+      auto& queue = queues_[i];
+      list.clear();
+
+      // Spin the objects around the view axis and write their matrices into the uniform block of the chunk.
+      for (auto j = first; j < first + count; j++) {
+        const auto half = (angle + phases_[j]) * 0.5f;
+        transforms_.rz[j] = std::sin(half);
+        transforms_.rw[j] = std::cos(half);
+      }
+      const auto offset = stride_ * static_cast<GLsizeiptr>(i);
+      math::multiply(view_projection_, transforms_, first, count, data + offset, sizeof(math::mat4));
+
+      // Queue the visible objects of the chunk.
+      const auto begin = std::lower_bound(visible.begin(), visible.end(), static_cast<std::uint32_t>(first));
+      const auto end = std::lower_bound(begin, visible.end(), static_cast<std::uint32_t>(first + count));
+      if (begin != end) {
+        list.bind_buffer_range(GL_UNIFORM_BUFFER, binding, buffer, region.offset + offset, block);
+      }
+      for (auto object = begin; object != end; ++object) {
+        const auto index = *object;
+        const auto shape = index % shapes;
+        const auto depth = (transforms_.pz[index] + 1.0f) * 0.5f;
+        gl::queue::packet packet;
+        packet.key = gl::queue::key(0, 1, static_cast<std::uint32_t>(shape), 0, depth);
+        packet.framebuffer = framebuffer;
+        packet.program = program;
+        packet.array = vao_[shape];
+        packet.count = shape ? 6 : 3;
+        packet.attribute = instance_;
+        packet.instance = static_cast<GLuint>(index - first);
+        queue.push(packet);
+      }
+      const auto position = static_cast<std::size_t>(begin - visible.begin());
+      const auto instance_offset = region.offset + matrices + static_cast<GLintptr>(position * sizeof(GLuint));
+      queue.submit(list, instances + position, buffer, instance_offset);
+    });
+    stream.unmap();
+
+    for (std::size_t i = 0; i < chunks; i++) {
+      lists_[i].replay();
+      packets_ += queues_[i].last().packets;
+      draws_ += queues_[i].last().draws;
+    }
+  }
+
+  // Returns the largest relative difference between the matrices of the vector kernel, which transforms
+  // several objects per iteration, the scalar path for the remainder, applied to one object at a time, and the
+  // product of the view projection with precomputed world matrices.
+  float check() const {
+    const auto view_projection = math::mat4::perspective(1.0f, 1.5f, 0.1f, 100.0f) *
+      math::mat4::look_at({ 1.0f, 2.0f, 3.0f }, {}, { 0.0f, 1.0f, 0.0f });
+    std::vector<math::mat4> world(count_);
+    std::vector<math::mat4> vector(count_);
+    std::vector<math::mat4> scalar(count_);
+    std::vector<math::mat4> product(count_);
+    math::multiply(view_projection, transforms_, 0, count_, vector.data(), sizeof(math::mat4));
+    for (std::size_t i = 0; i < count_; i++) {
+      math::multiply(view_projection, transforms_, i, 1, &scalar[i], sizeof(math::mat4));
+      world[i] = math::mat4::transform({ transforms_.px[i], transforms_.py[i], transforms_.pz[i] },
+        { transforms_.rx[i], transforms_.ry[i], transforms_.rz[i], transforms_.rw[i] },
+        { transforms_.sx[i], transforms_.sy[i], transforms_.sz[i] });
+    }
+    math::multiply(view_projection, world.data(), count_, product.data(), sizeof(math::mat4));
+
+    auto difference = 0.0f;
+    const auto compare = [&](const math::mat4& lhs, const math::mat4& rhs) {
+      float a[16];
+      float b[16];
+      std::memcpy(a, &lhs, sizeof(a));
+      std::memcpy(b, &rhs, sizeof(b));
+      for (std::size_t j = 0; j < 16; j++) {
+        difference = std::max(difference, std::abs(a[j] - b[j]) / std::max(1.0f, std::abs(b[j])));
+      }
+    };
+    for (std::size_t i = 0; i < count_; i++) {
+      compare(vector[i], scalar[i]);
+      compare(product[i], scalar[i]);
+    }
+    return difference;
+  }
+
+  // Number of packets pushed and draws submitted over all frames.
+  std::uint64_t packets() const noexcept {
+    return packets_;
+  }
+
+  std::uint64_t draws() const noexcept {
+    return draws_;
+  }
+
+  std::size_t size() const noexcept {
+    return count_;
+  }
+
+private:
+  static constexpr std::size_t shapes = 2;
+  static constexpr GLuint binding = 1;
+  static constexpr GLsizeiptr block = chunk * sizeof(math::mat4);
+
+  std::size_t count_ = 0;
+  gl::arrays vao_;
+  gl::buffers vbo_;
+  gl::program program_;
+  GLint instance_ = -1;
+  GLsizeiptr alignment_ = 256;
+  GLsizeiptr stride_ = block;
+
+  math::transforms transforms_;
+  math::spheres bounds_;
+  std::vector<float> phases_;
+  math::mat4 view_projection_;
+  math::frustum frustum_;
+
+  // Queue and command list of each chunk.
+  std::vector<gl::queue> queues_;
+  std::vector<gl::commands> lists_;
+  std::uint64_t packets_ = 0;
+  std::uint64_t draws_ = 0;
+};
@@ -0,0 +1,304 @@
+#include <context.h>
+#include <config.h>
+#include <gl/arrays.h>
+#include <gl/buffers.h>
+#include <gl/error.h>
+#include <gl/program.h>
+#include <gl/resource.h>
+#include <gl/textures.h>
+#include "arguments.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Micro-benchmarks for the gl wrapper layer.
+//
+// Measures name generation in bulk and one at a time, create/destroy churn and move assignment of the
+// gl::buffers, gl::arrays and gl::textures wrappers, the gl::resource overhead, error checks and program
+// attribute and uniform lookups on a headless context. Each benchmark is repeated and the fastest and the
+// median repetition are written as JSON in nanoseconds per operation.
+//
+// --iterations=N     operations per repetition (default 10000)
+// --repetitions=N    repetitions of each benchmark (default 5)
+// --filter=TEXT      only run benchmarks whose name contains TEXT
+// --output=FILE      write the JSON report to FILE instead of stdout
+
+namespace {
+
+struct arguments {
+  std::size_t iterations = 10000;
+  std::size_t repetitions = 5;
+  std::string filter;
+  std::string output;
+
+  arguments(int argc, char* argv[]) {
+    parse_arguments(argc, argv, [this](std::string_view key, std::string_view value) {
+      if (key == "--iterations") {
+        iterations = std::max<std::size_t>(1, std::strtoull(value.data(), nullptr, 10));
+      } else if (key == "--repetitions") {
+        repetitions = std::max<std::size_t>(1, std::strtoull(value.data(), nullptr, 10));
+      } else if (key == "--filter") {
+        filter = value;
+      } else if (key == "--output") {
+        output = value;
+      }
+    });
+  }
+};
+
+struct result {
+  std::string name;
+  double min = 0.0;
+  double median = 0.0;
+};
+
+// Resource without a GL object to measure the wrapper itself.
+struct handle {
+  static void release(GLuint handle) noexcept {
+    released += handle;
+  }
+
+  static inline volatile GLuint released = 0;
+};
+
+constexpr std::size_t bulk = 64;
+
+// Keeps the compiler from optimizing away the operations that produced the value.
+#ifdef _MSC_VER
+inline const void* volatile escaped = nullptr;
+#endif
+
+template <typename T>
+void escape(T& value) noexcept {
+#ifdef _MSC_VER
+  escaped = &value;
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+class suite : public context {
+public:
+  using clock = std::chrono::steady_clock;
+
+  suite(const arguments& args, int argc, char* argv[]) : context(argc, argv), args_(args) {}
+
+  void create(GLsizei cx, GLsizei cy, GLint dpi) override {
+    error_ = gl::policy();
+    wrappers();
+    lookups();
+    errors();
+    gl::policy(error_);
+  }
+
+  void resize(GLsizei cx, GLsizei cy, GLint dpi) override {}
+
+  void destroy() override {}
+
+  void render() override {}
+
+  const std::vector<result>& results() const noexcept {
+    return results_;
+  }
+
+private:
+  // Runs the operation args_.iterations times per repetition and records the time per operation.
+  template <typename Operation>
+  void measure(std::string name, std::size_t operations, Operation&& operation) {
+    if (!args_.filter.empty() && name.find(args_.filter) == std::string::npos) {
+      return;
+    }
+    const auto iterations = std::max<std::size_t>(1, args_.iterations / operations);
+    std::vector<double> times;
+    for (std::size_t repetition = 0; repetition < args_.repetitions; repetition++) {
+      // Let the driver process deferred deletions outside of the measurement.
+      glFinish();
+      const auto start = clock::now();
+      for (std::size_t i = 0; i < iterations; i++) {
+        operation();
+      }
+      const auto stop = clock::now();
+      const auto ns = std::chrono::duration<double, std::nano>(stop - start).count();
+      times.push_back(ns / static_cast<double>(iterations * operations));
+    }
+    std::sort(times.begin(), times.end());
+    results_.push_back({ std::move(name), times.front(), times[times.size() / 2] });
+
+    // Check for errors regardless of the policy under test.
+    if (const auto ec = gl::error()) {
+      throw gl::system_error(ec, "Benchmark " + results_.back().name + " failed");
+    }
+  }
+
+  // Measures one set of name generation benchmarks per wrapper type.
+  template <typename Wrapper, typename Generate, typename Delete>
+  void names(const char* type, Generate generate, Delete destroy) {
+    const auto prefix = std::string(type) + ".";
+
+    // Name generation in bulk and one at a time, per generated name.
+    measure(prefix + "raw.bulk", bulk, [&]() {
+      GLuint handles[bulk];
+      generate(static_cast<GLsizei>(bulk), handles);
+      destroy(static_cast<GLsizei>(bulk), handles);
+    });
+    measure(prefix + "raw.single", 1, [&]() {
+      GLuint handle = 0;
+      generate(1, &handle);
+      destroy(1, &handle);
+    });
+    measure(prefix + "bulk", bulk, [&]() {
+      Wrapper wrapper(bulk);
+    });
+    measure(prefix + "single", 1, [&]() {
+      Wrapper wrapper(1);
+    });
+
+    // Replace a live wrapper, which deletes the previous names.
+    Wrapper wrapper(1);
+    measure(prefix + "move_assign", 1, [&]() {
+      wrapper = Wrapper(1);
+    });
+
+    // Churn through a set of wrappers that are destroyed in a different order than they were created.
+    measure(prefix + "churn", 16, [&]() {
+      std::vector<Wrapper> wrappers;
+      wrappers.reserve(16);
+      for (auto i = 0; i < 16; i++) {
+        wrappers.emplace_back(1);
+      }
+      for (std::size_t i = 0; i < wrappers.size(); i += 2) {
+        wrappers[i] = {};
+      }
+    });
+  }
+
+  void wrappers() {
+    gl::policy(gl::error_policy::none);
+    names<gl::buffers>("buffers", glGenBuffers, glDeleteBuffers);
+    names<gl::arrays>("arrays", glGenVertexArrays, glDeleteVertexArrays);
+    names<gl::textures>("textures", glGenTextures, glDeleteTextures);
+
+    // Wrapper overhead without GL calls.
+    GLuint next = 1;
+    gl::resource<GLuint, handle> resource(next++);
+    measure("resource.move_assign", 1, [&]() {
+      resource = gl::resource<GLuint, handle>(next++);
+      escape(resource);
+    });
+    measure("resource.move_construct", 1, [&]() {
+      gl::resource<GLuint, handle> other(std::move(resource));
+      escape(other);
+      resource = std::move(other);
+      escape(resource);
+    });
+  }
+
+  void lookups() {
+    gl::policy(gl::error_policy::none);
+    const std::string_view vert =
+      "#version 300 es\n"
+      "precision mediump float;\n"
+      "in vec2 position;\n"
+      "in vec4 color;\n"
+      "out vec4 vert_color;\n"
+      "uniform mat4 transform;\n"
+      "uniform vec4 tint;\n"
+      "void main() {\n"
+      "  vert_color = color * tint;\n"
+      "  gl_Position = transform * vec4(position, 0.0, 1.0);\n"
+      "}";
+
+    const std::string_view frag =
+      "#version 300 es\n"
+      "precision mediump float;\n"
+      "in vec4 vert_color;\n"
+      "uniform float alpha;\n"
+      "out vec4 frag_color;\n"
+      "void main() {\n"
+      "  frag_color = vec4(vert_color.rgb, vert_color.a * alpha);\n"
+      "}";
+
+    const gl::program program(vert, frag);
+    volatile GLint location = 0;
+    measure("program.attribute", 1, [&]() {
+      location = program.attribute("color");
+    });
+    measure("program.uniform.raw", 1, [&]() {
+      location = glGetUniformLocation(program, "alpha");
+    });
+
+    // Locations of active uniforms are resolved after linking.
+    measure("program.uniform", 1, [&]() {
+      location = program.uniform("alpha");
+    });
+    measure("program.uniform.missing", 1, [&]() {
+      location = program.uniform("missing");
+    });
+  }
+
+  void errors() {
+    volatile bool failed = false;
+    measure("error", 1, [&]() {
+      failed = static_cast<bool>(gl::error());
+    });
+    // Policies above the GL_ERROR_POLICY limit of the build are skipped, since they would measure a lower policy.
+    for (const auto policy : { gl::error_policy::none, gl::error_policy::frame, gl::error_policy::call }) {
+      gl::policy(policy);
+      if (gl::policy() != policy) {
+        continue;
+      }
+      const auto name = policy == gl::error_policy::none ? "none" : policy == gl::error_policy::frame ? "frame" : "call";
+      measure(std::string("error.check.") + name, 1, [&]() {
+        failed = static_cast<bool>(gl::check());
+      });
+    }
+  }
+
+  const arguments& args_;
+  gl::error_policy error_ = gl::error_policy::none;
+  std::vector<result> results_;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  // Render a single frame without multisampling. Later arguments override the defaults.
+  forwarded_arguments forwarded(argc, argv, { "--frames=1", "--size=64x64", "--samples=0", "--pacing=uncapped" });
+  const arguments args(argc, argv);
+  suite suite(args, forwarded.argc(), forwarded.argv());
+  if (const auto result = suite.run()) {
+    return result;
+  }
+  auto file = stdout;
+  if (!args.output.empty()) {
+    file = std::fopen(args.output.data(), "wb");
+    if (!file) {
+      std::fprintf(stderr, "%s: could not open %s\n", PROJECT, args.output.data());
+      return 1;
+    }
+  }
+  std::fprintf(file, "{\n");
+  std::fprintf(file, "  \"iterations\": %zu,\n", args.iterations);
+  std::fprintf(file, "  \"repetitions\": %zu,\n", args.repetitions);
+  std::fprintf(file, "  \"results\": [\n");
+  const auto& results = suite.results();
+  for (std::size_t i = 0; i < results.size(); i++) {
+    std::fprintf(file, "    {\"name\": \"%s\", \"min_ns\": %.1f, \"median_ns\": %.1f}%s\n", results[i].name.data(),
+      results[i].min, results[i].median, i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(file, "  ]\n");
+  std::fprintf(file, "}\n");
+  if (file != stdout) {
+    std::fclose(file);
+  }
+  return 0;
+}
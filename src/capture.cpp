@@ -0,0 +1,322 @@
+#include "capture.h"
+#include <gl/error.h>
+#include <gl/state.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::uint32_t crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0) noexcept {
+  static const auto table = []() {
+    std::array<std::uint32_t, 256> table = {};
+    for (std::uint32_t i = 0; i < 256; i++) {
+      auto value = i;
+      for (auto j = 0; j < 8; j++) {
+        value = value & 1 ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+      }
+      table[i] = value;
+    }
+    return table;
+  }();
+  crc = ~crc;
+  for (std::size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+void put(std::vector<std::uint8_t>& data, std::uint32_t value) {
+  data.push_back(static_cast<std::uint8_t>(value >> 24));
+  data.push_back(static_cast<std::uint8_t>(value >> 16));
+  data.push_back(static_cast<std::uint8_t>(value >> 8));
+  data.push_back(static_cast<std::uint8_t>(value));
+}
+
+void chunk(std::ofstream& file, const char* type, const std::vector<std::uint8_t>& data) {
+  std::vector<std::uint8_t> header;
+  put(header, static_cast<std::uint32_t>(data.size()));
+  header.insert(header.end(), type, type + 4);
+  auto crc = crc32(header.data() + 4, 4);
+  crc = crc32(data.data(), data.size(), crc);
+  std::vector<std::uint8_t> footer;
+  put(footer, crc);
+  file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+  file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+  file.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+}
+
+std::filesystem::path filename(const std::filesystem::path& directory, std::uint64_t index, const char* extension) {
+  char name[32] = {};
+  std::snprintf(name, sizeof(name), "%06llu.%s", static_cast<unsigned long long>(index), extension);
+  return directory / name;
+}
+
+}  // namespace
+
+capture::capture(consumer consumer) : consumer_(std::move(consumer)) {
+  worker_ = std::thread([this]() { run(); });
+}
+
+capture::~capture() {
+  try {
+    poll(true);
+  }
+  catch (...) {
+  }
+  for (auto& slot : slots_) {
+    unmap(slot, true);
+  }
+
+  // The worker finishes the queued frames before it returns.
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+  for (auto& slot : slots_) {
+    slot.fence = {};
+    if (slot.buffer) {
+      gl::state::forget_buffers(1, &slot.buffer);
+      glDeleteBuffers(1, &slot.buffer);
+    }
+  }
+}
+
+void capture::read(GLuint framebuffer, GLsizei cx, GLsizei cy, std::uint64_t index) {
+  poll();
+
+  // Wait for the oldest read when all buffers are in flight.
+  auto& slot = slots_[head_ % depth];
+  if (slot.pending) {
+    slot.fence.wait();
+    poll();
+  }
+  unmap(slot, true, true);
+  const auto size = static_cast<GLsizeiptr>(cx) * cy * 4;
+  if (!slot.buffer) {
+    glGenBuffers(1, &slot.buffer);
+  }
+  gl::bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  if (slot.capacity < size) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    slot.capacity = size;
+  }
+  gl::bind_framebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, cx, cy, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  gl::bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (const auto ec = gl::check()) {
+    throw gl::system_error(ec, "Could not read framebuffer");
+  }
+  slot.fence = gl::fence(GL_SYNC_GPU_COMMANDS_COMPLETE);
+  slot.cx = cx;
+  slot.cy = cy;
+  slot.index = index;
+  slot.pending = true;
+  head_++;
+}
+
+void capture::poll(bool wait) {
+  for (; tail_ < head_; tail_++) {
+    auto& slot = slots_[tail_ % depth];
+    if (!wait && !slot.fence.signaled()) {
+      break;
+    }
+    complete(slot);
+  }
+  for (auto& slot : slots_) {
+    unmap(slot, false);
+  }
+  std::lock_guard lock(mutex_);
+  if (exception_) {
+    std::rethrow_exception(std::exchange(exception_, nullptr));
+  }
+}
+
+std::uint64_t capture::dropped() const noexcept {
+  std::lock_guard lock(mutex_);
+  return dropped_;
+}
+
+capture::consumer capture::raw(std::filesystem::path directory) {
+  std::filesystem::create_directories(directory);
+  return [directory = std::move(directory)](const frame& frame) {
+    const auto path = filename(directory, frame.index, "rgba");
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(frame.pixels.data()), static_cast<std::streamsize>(frame.pixels.size()));
+    if (!file) {
+      throw gl::runtime_error("Could not write frame: " + path.string());
+    }
+  };
+}
+
+capture::consumer capture::png(std::filesystem::path directory) {
+  std::filesystem::create_directories(directory);
+  return [directory = std::move(directory)](const frame& frame) {
+    write_png(filename(directory, frame.index, "png"), frame);
+  };
+}
+
+void capture::write_png(const std::filesystem::path& path, const frame& frame) {
+  std::ofstream file(path, std::ios::binary);
+  const std::uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+  file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+  // 8-bit RGBA, deflate, no filter, no interlace.
+  std::vector<std::uint8_t> header;
+  put(header, static_cast<std::uint32_t>(frame.cx));
+  put(header, static_cast<std::uint32_t>(frame.cy));
+  header.insert(header.end(), { 8, 6, 0, 0, 0 });
+  chunk(file, "IHDR", header);
+
+  // Scanlines with filter type 0 in stored deflate blocks.
+  const auto stride = static_cast<std::size_t>(frame.cx) * 4;
+  std::vector<std::uint8_t> scanlines;
+  scanlines.reserve((stride + 1) * static_cast<std::size_t>(frame.cy));
+  for (GLsizei y = 0; y < frame.cy; y++) {
+    scanlines.push_back(0);
+    const auto row = frame.pixels.data() + stride * static_cast<std::size_t>(y);
+    scanlines.insert(scanlines.end(), row, row + stride);
+  }
+  std::vector<std::uint8_t> data = { 0x78, 0x01 };
+  data.reserve(scanlines.size() + scanlines.size() / 65535 * 5 + 16);
+  std::size_t offset = 0;
+  do {
+    const auto size = std::min<std::size_t>(scanlines.size() - offset, 65535);
+    data.push_back(offset + size == scanlines.size() ? 1 : 0);
+    data.push_back(static_cast<std::uint8_t>(size));
+    data.push_back(static_cast<std::uint8_t>(size >> 8));
+    data.push_back(static_cast<std::uint8_t>(~size));
+    data.push_back(static_cast<std::uint8_t>(~size >> 8));
+    data.insert(data.end(), scanlines.begin() + static_cast<std::ptrdiff_t>(offset),
+      scanlines.begin() + static_cast<std::ptrdiff_t>(offset + size));
+    offset += size;
+  } while (offset < scanlines.size());
+  std::uint32_t a = 1;
+  std::uint32_t b = 0;
+  for (const auto value : scanlines) {
+    a = (a + value) % 65521;
+    b = (b + a) % 65521;
+  }
+  put(data, (b << 16) | a);
+  chunk(file, "IDAT", data);
+  chunk(file, "IEND", {});
+  if (!file) {
+    throw gl::runtime_error("Could not write frame: " + path.string());
+  }
+}
+
+void capture::complete(slot& slot) {
+  slot.fence.wait();
+  slot.fence = {};
+  slot.pending = false;
+
+  std::unique_lock lock(mutex_);
+  if (queue_.size() + copies_.size() >= backlog || exception_) {
+    dropped_++;
+    return;
+  }
+  std::vector<std::uint8_t> pixels;
+  if (!free_.empty()) {
+    pixels = std::move(free_.back());
+    free_.pop_back();
+  }
+  lock.unlock();
+
+  // Keep the buffer mapped until the worker copied the pixels.
+  const auto size = static_cast<GLsizeiptr>(slot.cx) * slot.cy * 4;
+  gl::bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  const auto data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  gl::bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (!data) {
+    throw gl::system_error(gl::error(), "Could not map pixel pack buffer");
+  }
+  slot.data = static_cast<const std::uint8_t*>(data);
+
+  lock.lock();
+  slot.copying = true;
+  copies_.push_back({ &slot, std::move(pixels) });
+  lock.unlock();
+  cv_.notify_one();
+}
+
+void capture::unmap(slot& slot, bool wait, bool drop) {
+  if (!slot.data) {
+    return;
+  }
+  std::unique_lock lock(mutex_);
+  if (slot.copying) {
+    if (!wait) {
+      return;
+    }
+
+    // Drop the frame when requested and the worker did not start copying it yet, otherwise wait for the copy.
+    const auto it = std::find_if(copies_.begin(), copies_.end(), [&](const copy& copy) { return copy.slot == &slot; });
+    if (drop && it != copies_.end()) {
+      free_.push_back(std::move(it->pixels));
+      copies_.erase(it);
+      slot.copying = false;
+      dropped_++;
+    }
+    copied_.wait(lock, [&]() { return !slot.copying; });
+  }
+  lock.unlock();
+  gl::bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  gl::bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.data = nullptr;
+}
+
+void capture::run() {
+  std::unique_lock lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stopping_ || !copies_.empty() || !queue_.empty(); });
+
+    // Copy mapped buffers first, so that the render thread can unmap and reuse them.
+    if (!copies_.empty()) {
+      auto copy = std::move(copies_.front());
+      copies_.pop_front();
+      const auto& slot = *copy.slot;
+      lock.unlock();
+
+      // OpenGL returns the bottom row first.
+      const auto stride = static_cast<std::size_t>(slot.cx) * 4;
+      copy.pixels.resize(stride * static_cast<std::size_t>(slot.cy));
+      for (GLsizei y = 0; y < slot.cy; y++) {
+        std::memcpy(copy.pixels.data() + stride * static_cast<std::size_t>(slot.cy - 1 - y),
+          slot.data + stride * static_cast<std::size_t>(y), stride);
+      }
+      frame frame{ slot.index, slot.cx, slot.cy, std::move(copy.pixels) };
+
+      lock.lock();
+      copy.slot->copying = false;
+      queue_.push_back(std::move(frame));
+      copied_.notify_all();
+      continue;
+    }
+    if (queue_.empty()) {
+      return;
+    }
+    auto frame = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+
+    std::exception_ptr exception;
+    try {
+      consumer_(frame);
+    }
+    catch (...) {
+      exception = std::current_exception();
+    }
+
+    lock.lock();
+    if (exception && !exception_) {
+      exception_ = exception;
+    }
+    free_.push_back(std::move(frame.pixels));
+  }
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <gl/fence.h>
+#include <GLES3/gl3.h>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Reads rendered frames back asynchronously.
+//
+// Each read copies the framebuffer into a pixel pack buffer from a ring and inserts a fence. Buffers are mapped
+// a few frames later once their fence signaled, so that the render thread does not wait for the GPU. A worker
+// thread copies the mapped pixels into a recycled frame buffer and hands the frame to a consumer. The render
+// thread only maps and unmaps buffers. Frames are dropped when the consumer can not keep up.
+class capture {
+public:
+  struct frame {
+    std::uint64_t index = 0;
+    GLsizei cx = 0;
+    GLsizei cy = 0;
+
+    // Tightly packed RGBA8 pixels, top row first.
+    std::vector<std::uint8_t> pixels;
+  };
+
+  // Called on the worker thread. Exceptions stop the capture and are rethrown by the next read().
+  using consumer = std::function<void(const frame& frame)>;
+
+  // Number of pixel pack buffers in the ring.
+  static constexpr std::size_t depth = 3;
+
+  // Number of frames queued for the consumer before frames are dropped.
+  static constexpr std::size_t backlog = 8;
+
+  explicit capture(consumer consumer);
+
+  capture(capture&& other) = delete;
+  capture& operator=(capture&& other) = delete;
+
+  // Completes pending reads and waits for the consumer. Must be called with a current context.
+  ~capture();
+
+  // Reads the lower left region of the framebuffer. Must be called with a current context.
+  void read(GLuint framebuffer, GLsizei cx, GLsizei cy, std::uint64_t index);
+
+  // Hands completed reads to the consumer. Blocks for pending reads when wait is true.
+  void poll(bool wait = false);
+
+  std::uint64_t dropped() const noexcept;
+
+  // Writes each frame to "<directory>/<index>.rgba" as raw RGBA8 pixels.
+  static consumer raw(std::filesystem::path directory);
+
+  // Writes each frame to "<directory>/<index>.png".
+  static consumer png(std::filesystem::path directory);
+
+  // Writes an uncompressed RGBA8 PNG image.
+  static void write_png(const std::filesystem::path& path, const frame& frame);
+
+private:
+  struct slot {
+    GLuint buffer = 0;
+    GLsizeiptr capacity = 0;
+    gl::fence fence;
+    GLsizei cx = 0;
+    GLsizei cy = 0;
+    std::uint64_t index = 0;
+    bool pending = false;
+
+    // Mapped pixels while the worker copies them. The buffer is unmapped on the render thread afterwards.
+    const std::uint8_t* data = nullptr;
+
+    // Set while the copy is queued or running. Guarded by the mutex.
+    bool copying = false;
+  };
+
+  // Copy of a mapped buffer into a recycled frame buffer.
+  struct copy {
+    capture::slot* slot = nullptr;
+    std::vector<std::uint8_t> pixels;
+  };
+
+  void complete(slot& slot);
+  void unmap(slot& slot, bool wait, bool drop = false);
+  void run();
+
+  consumer consumer_;
+  std::array<slot, depth> slots_;
+  std::uint64_t head_ = 0;
+  std::uint64_t tail_ = 0;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable copied_;
+  std::deque<copy> copies_;
+  std::deque<frame> queue_;
+  std::vector<std::vector<std::uint8_t>> free_;
+  std::exception_ptr exception_;
+  std::uint64_t dropped_ = 0;
+  bool stopping_ = false;
+  std::thread worker_;
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include <context.h>
+#include <gl/error.h>
+#include <gl/arrays.h>
+#include <gl/buffers.h>
+#include <gl/commands.h>
+#include <gl/program.h>
+#include <gl/queue.h>
+#include <gl/uniform.h>
+#include <gl/vertex.h>
+#include <math/batch.h>
+#include <math/cull.h>
+#include <math/matrix.h>
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+struct vertex {
+  std::array<gl::half, 2> position;
+  std::array<gl::unorm8, 4> color;
+};
+
+template <>
+struct gl::vertex_layout<vertex> {
+  static constexpr std::array attributes = {
+    GL_VERTEX_ATTRIBUTE(vertex, position),
+    GL_VERTEX_ATTRIBUTE(vertex, color),
+  };
+};
+
+// Per-frame uniform block.
+struct frame {
+  gl::std140::mat4 transform;
+};
+
+GL_STD140_OFFSET(frame, transform, 0);
+
+// Test scene. Renders a triangle with an aspect ratio correcting transform.
+class client : public context {
+public:
+  using context::context;
+
+  void create(GLsizei cx, GLsizei cy, GLint dpi) override {
+    // Create scene.
+    state().enable(GL_BLEND, true);
+    state().enable(GL_DEPTH_TEST, true);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glClearColor(0.2f, 0.4f, 0.6f, 1.0f);
+
+    // Load resources.
+    const std::string_view vert =
+      "#version 300 es\n"
+      "precision mediump float;\n"
+      "in vec2 position;\n"
+      "in vec3 color;\n"
+      "out vec3 vert_color;\n"
+      "layout(std140) uniform frame {\n"
+      "  mat4 transform;\n"
+      "};\n"
+      "void main() {\n"
+      "  vert_color = color;\n"
+      "  gl_Position = transform * vec4(position, 0.0, 1.0);\n"
+      "}";
+
+    const std::string_view frag =
+      "#version 300 es\n"
+      "precision mediump float;\n"
+      "in vec3 vert_color;\n"
+      "out vec4 frag_color;\n"
+      "void main() {\n"
+      "  frag_color = vec4(vert_color, 1.0);\n"
+      "}";
+
+    // Create scene objects.
+    vao_ = gl::arrays(1);
+    vbo_ = gl::buffers(2);
+    program_ = gl::program(vert, frag, shader_cache());
+    program_.block("frame", frame_binding, sizeof(frame));
+
+    // The frame block is written to the stream buffer every frame.
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment_);
+    alignment_ = std::max(alignment_, 16);
+
+    // Create vertices VBO.
+    const vertex vertices[] = {
+      // Position       Color
+      { {  0.0f,  0.5f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
+      { {  0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
+      { { -0.5f, -0.5f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
+    };
+    state().bind_buffer(GL_ARRAY_BUFFER, vbo_[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    // Create elements VBO.
+    const unsigned elements[] = {
+      0, 1, 2
+    };
+    state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, vbo_[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
+
+    // Add enabled attributes (including their layout information and currently bound buffers) to the VAO.
+    vao_.layout<vertex>(0, program_, vbo_[0], vbo_[1]);
+
+    // Transform and bounding sphere of the triangle.
+    transforms_.resize(1);
+    bounds_.resize(1);
+    bounds_.set(0, { 0.0f, 0.0f, 0.0f }, std::sqrt(0.5f));
+  }
+
+  void resize(GLsizei cx, GLsizei cy, GLint dpi) override {
+    state().viewport(0, 0, cx, cy);
+
+    // Keep the aspect ratio of the scene. The matrix is written straight into the frame block.
+    const auto projection = math::mat4::scale({ static_cast<float>(cy) / static_cast<float>(cx), 1.0f, 1.0f });
+    math::multiply(projection, transforms_, 0, 1, &frame_.transform, sizeof(frame));
+    frustum_ = math::frustum::extract(projection);
+  }
+
+  void destroy() override {
+    draw_ = {};
+    program_ = {};
+    vbo_ = {};
+    vao_ = {};
+  }
+
+  void render() override {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (cull(frustum_, bounds_).empty()) {
+      return;
+    }
+
+    // Submit the triangle through the draw queue and replay the recorded commands.
+    draw_.clear();
+    const auto offset = stream().write(&frame_, sizeof(frame), alignment_);
+    draw_.bind_buffer_range(GL_UNIFORM_BUFFER, frame_binding, stream(), offset, sizeof(frame));
+    gl::queue::packet packet;
+    packet.key = gl::queue::key(0, 0, 0, 0, 0.5f);
+    packet.framebuffer = framebuffer();
+    packet.program = program_;
+    packet.array = vao_[0];
+    packet.count = 3;
+    queue_.push(packet);
+    queue_.submit(draw_, stream());
+    draw_.replay();
+  }
+
+private:
+  static constexpr GLuint frame_binding = 0;
+
+  gl::arrays vao_;
+  gl::buffers vbo_;
+  gl::program program_;
+  frame frame_;
+  GLint alignment_ = 256;
+  math::frustum frustum_;
+  math::transforms transforms_;
+  math::spheres bounds_;
+  gl::queue queue_;
+  gl::commands draw_;
+};
@@ -1,51 +1,87 @@
 #include "context.h"
-#include <egl/egl.h>
-#include <egl/eglext.h>
-#include <egl/eglplatform.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <EGL/eglplatform.h>
 #include <egl/error.h>
-#include <chrono>
+#include <gl/debug.h>
+#include <gl/error.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
 
-void context::on_create(GLsizei cx, GLsizei cy, GLint dpi) {
-  // Create OpenGL ES display.
-  // TODO: Set EGL_EXPERIMENTAL_PRESENT_PATH_ANGLE to EGL_EXPERIMENTAL_PRESENT_PATH_FAST_ANGLE and
-  //       fall back to EGL_EXPERIMENTAL_PRESENT_PATH_COPY_ANGLE if eglChooseConfig fails.
-  const EGLint platform_attributes[] = {
-    EGL_PLATFORM_ANGLE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_TYPE_D3D11_ANGLE,
-    EGL_PLATFORM_ANGLE_DEVICE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_DEVICE_TYPE_HARDWARE_ANGLE,
-    EGL_EXPERIMENTAL_PRESENT_PATH_ANGLE, EGL_EXPERIMENTAL_PRESENT_PATH_COPY_ANGLE,
-    EGL_PLATFORM_ANGLE_ENABLE_AUTOMATIC_TRIM_ANGLE, EGL_TRUE,
-    EGL_NONE,
-  };
-  display_ = eglGetPlatformDisplayEXT(EGL_PLATFORM_ANGLE_ANGLE, nateive_display(), platform_attributes);
-  if (display_ == EGL_NO_DISPLAY) {
-    display_ = eglGetDisplay(nateive_display());
+namespace {
+
+GLsizei round_up(GLsizei size, GLsizei bucket) noexcept {
+  return (std::max(size, 1) + bucket - 1) / bucket * bucket;
+}
+
+bool has_extension(const char* extensions, const char* name) noexcept {
+  if (!extensions) {
+    return false;
   }
-  if (display_ == EGL_NO_DISPLAY) {
-    throw egl::system_error(egl::error(), "Could not create OpenGL ES display");
+  const auto size = std::strlen(name);
+  for (auto pos = std::strstr(extensions, name); pos; pos = std::strstr(pos + size, name)) {
+    if ((pos == extensions || pos[-1] == ' ') && (pos[size] == ' ' || pos[size] == '\0')) {
+      return true;
+    }
   }
-  if (!eglInitialize(display_, nullptr, nullptr)) {
-    throw egl::system_error(egl::error(), "Could not initialize OpenGL ES display");
+  return false;
+}
+
+EGLDisplay get_platform_display(EGLenum platform, void* native_display, const EGLint* attributes) noexcept {
+  // The EXT entry point is not exported by every EGL implementation (e.g. libglvnd).
+  const auto proc = eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (!proc) {
+    return EGL_NO_DISPLAY;
   }
+  return reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(proc)(platform, native_display, attributes);
+}
 
-  // Choose OpenGL ES configuration.
-  EGLConfig config = {};
-  EGLint config_count = 0;
-  EGLint attributes[] = {
-    EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
-    EGL_CONFORMANT, EGL_OPENGL_ES3_BIT,
-    EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-    EGL_RED_SIZE, 8,
-    EGL_GREEN_SIZE, 8,
-    EGL_BLUE_SIZE, 8,
-    EGL_ALPHA_SIZE, 0,
-    EGL_STENCIL_SIZE, 8,
-    EGL_NONE
-  };
-  if (!eglChooseConfig(display_, attributes, &config, 1, &config_count)) {
-    throw egl::system_error(egl::error(), "Could not choose OpenGL ES config");
+// Backends tried when no fallback chain was specified.
+#if defined(EGL_PLATFORM_ANGLE_ANGLE) && defined(WIN32)
+constexpr const char* default_backends = "d3d11,default";
+#elif defined(EGL_PLATFORM_ANGLE_ANGLE)
+constexpr const char* default_backends = "swiftshader,default";
+#else
+constexpr const char* default_backends = "surfaceless,default";
+#endif
+
+std::vector<std::string> split(std::string_view list) {
+  std::vector<std::string> names;
+  while (!list.empty()) {
+    const auto pos = list.find(',');
+    const auto name = list.substr(0, pos);
+    if (!name.empty()) {
+      names.emplace_back(name);
+    }
+    list = pos == std::string_view::npos ? std::string_view() : list.substr(pos + 1);
   }
-  if (config_count < 1) {
-    throw egl::runtime_error("Could not chose a valid OpenGL ES 3 config.");
+  return names;
+}
+
+}  // namespace
+
+void context::on_create(GLsizei cx, GLsizei cy, GLint dpi) {
+  const auto headless = !native_window();
+
+  // Create OpenGL ES display with the first backend in the fallback chain that provides a matching config.
+  std::string tried;
+  for (const auto& name : split(settings().backend.empty() ? default_backends : settings().backend)) {
+    if (create_display(name, headless)) {
+      backend_ = name;
+      break;
+    }
+    tried += (tried.empty() ? "" : ", ") + name;
+  }
+  if (display_ == EGL_NO_DISPLAY) {
+    throw egl::runtime_error("Could not create an OpenGL ES 3 display with a valid config (tried " + tried + ").");
+  }
+  if (settings().profile) {
+    std::fprintf(stdout, "backend  %s\n", backend_.data());
   }
 
   // Bind OpenGL ES API.
@@ -54,9 +90,13 @@ void context::on_create(GLsizei cx, GLsizei cy, GLint dpi) {
   }
 
   // Create OpenGL ES surface.
-  surface_ = eglCreateWindowSurface(display_, config, native_window(), nullptr);
-  if (surface_ == EGL_NO_SURFACE) {
-    throw egl::system_error(egl::error(), "Could not create OpenGL ES surface");
+  if (!headless) {
+    surface_ = eglCreateWindowSurface(display_, config_, native_window(), nullptr);
+    if (surface_ == EGL_NO_SURFACE) {
+      throw egl::system_error(egl::error(), "Could not create OpenGL ES surface");
+    }
+  } else if (!surfaceless_) {
+    create_pbuffer(round_up(cx, bucket), round_up(cy, bucket));
   }
 
   // Create OpenGL ES context.
@@ -64,7 +104,7 @@ void context::on_create(GLsizei cx, GLsizei cy, GLint dpi) {
     EGL_CONTEXT_CLIENT_VERSION, 3,
     EGL_NONE
   };
-  context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT, ctxattr);
+  context_ = eglCreateContext(display_, config_, EGL_NO_CONTEXT, ctxattr);
   if (context_ == EGL_NO_CONTEXT) {
     throw egl::system_error(egl::error(), "Could not create OpenGL ES context");
   }
@@ -72,22 +112,54 @@ void context::on_create(GLsizei cx, GLsizei cy, GLint dpi) {
     throw egl::system_error(egl::error(), "Could not attach OpenGL ES context");
   }
 
-  // Create renderbuffer and framebuffer for multisampling.
-  if (samples_ > 1) {
-    // Create renderbuffer.
-    glGenRenderbuffers(1, &rbo_);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo_);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_, GL_BGRA8_EXT, cx, cy);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+  // Set swap interval for the selected frame pacing mode.
+  if (surface_ != EGL_NO_SURFACE) {
+    eglSwapInterval(display_, settings().pacing == pacing::vsync ? 1 : 0);
+  }
+
+  // Set error checking policy and install debug message callback.
+  gl::policy(settings().gl_errors);
+  if (settings().gl_debug) {
+    gl::debug([](const gl::debug_message& message) {
+      std::fprintf(stderr, "OpenGL ES: %s%s%s\n", message.text.data(),
+        message.location.empty() ? "" : " in ", message.location.data());
+    }, settings().gl_debug_sync);
+  }
+
+  // Create frame timing queries.
+  profiler_.create();
+
+  // Open program binary cache.
+  cache_ = gl::cache(settings().shader_cache);
 
-    // Create framebuffer and set renderbuffer.
-    glGenFramebuffers(1, &fbo_);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rbo_);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  // Track bindings of this context on the render thread.
+  state_.reset();
+  gl::state::current(&state_);
+
+  // Track frames in flight.
+  fences_.clear();
+  fences_.resize(settings().frames_in_flight);
+  frame_ = 0;
+  stalls_ = 0;
+
+  // Create the multisampled scene target and the offscreen output target in surfaceless mode.
+  samples_ = gl::target::samples(format(), settings().samples);
+  create_targets(cx, cy);
+  if (settings().dynamic_resolution > 0.0f) {
+    resolution_.emplace(settings().dynamic_resolution);
+  }
+
+  // Start capturing frames.
+  if (!settings().capture.empty()) {
+    capture_frames(settings().capture_raw ? capture::raw(settings().capture) : capture::png(settings().capture));
   }
 
   // Create scene.
+  cx_ = cx;
+  cy_ = cy;
+  rx_ = cx;
+  ry_ = cy;
+  state_.bind_framebuffer(GL_FRAMEBUFFER, target_);
   create(cx, cy, dpi);
   resize(cx, cy, dpi);
 
@@ -98,26 +170,69 @@ void context::on_create(GLsizei cx, GLsizei cy, GLint dpi) {
 void context::on_resize(GLsizei cx, GLsizei cy, GLint dpi) {
   cx_ = cx;
   cy_ = cy;
-  if (samples_ > 1) {
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo_);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples_, GL_BGRA8_EXT, cx, cy);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
-    glGetError();
-  }
+  rx_ = cx;
+  ry_ = cy;
+  create_targets(cx, cy);
   resize(cx, cy, dpi);
-  static auto beg = std::chrono::system_clock::now();
-  auto now = std::chrono::system_clock::now();
-  if (now - beg > std::chrono::milliseconds(16)) {
-    on_render();
-    beg = now;
-  }
 }
 
 void context::on_destroy() {
-  // Destroy framebuffer and renderbuffer.
-  if (samples_ > 1) {
-    glDeleteFramebuffers(1, &fbo_);
-    glDeleteRenderbuffers(1, &rbo_);
+  // Destroy scene and finish captured frames while the context is still current.
+  std::uint64_t dropped = 0;
+  if (context_ != EGL_NO_CONTEXT) {
+    destroy();
+    stream_.reset();
+    streamer_.reset();
+    jobs_.reset();
+    if (capture_) {
+      capture_->poll(true);
+      dropped = capture_->dropped();
+      capture_.reset();
+    }
+  }
+
+  // Report and destroy frame timing queries.
+  if (settings().profile) {
+    profiler_.print(stdout);
+    if (const auto frames = state_.frames()) {
+      const auto& total = state_.total();
+      std::fprintf(stdout, "state    %.1f calls  %.1f elided per frame\n",
+        static_cast<double>(total.calls) / frames, static_cast<double>(total.elided) / frames);
+    }
+    if (resolution_) {
+      std::fprintf(stdout, "scale    %.3f at %dx%d  budget %.1f ms\n",
+        static_cast<double>(resolution_->scale()), rx_, ry_, static_cast<double>(resolution_->budget()));
+    }
+    std::fprintf(stdout, "pipeline %zu frames in flight  %llu stalls\n", fences_.size(),
+      static_cast<unsigned long long>(stalls_));
+    if (captured_) {
+      std::fprintf(stdout, "capture  %llu frames  %llu dropped\n",
+        static_cast<unsigned long long>(captured_), static_cast<unsigned long long>(dropped));
+    }
+  }
+  profiler_.destroy();
+  gl::debug_reset();
+  for (auto& fence : fences_) {
+    fence = {};
+  }
+
+  // Destroy views and render targets.
+  while (!views_.empty()) {
+    destroy_view(*views_.back());
+  }
+  resolved_.reset();
+  scaled_.reset();
+  scene_.reset();
+  output_.reset();
+  targets_.clear();
+  target_ = 0;
+  framebuffer_ = 0;
+  ax_ = 0;
+  ay_ = 0;
+
+  // Stop tracking bindings.
+  if (gl::state::current() == &state_) {
+    gl::state::current(nullptr);
   }
 
   // Destroy OpenGL ES display, context and surface.
@@ -136,24 +251,466 @@ void context::on_destroy() {
   }
 }
 
+gl::stream& context::stream() {
+  if (!stream_) {
+    stream_ = std::make_unique<gl::stream>(stream_capacity, fences_.size());
+    stream_->begin_frame(frame_index());
+  }
+  return *stream_;
+}
+
+streamer& context::textures() {
+  if (!streamer_) {
+    streamer_ = std::make_unique<streamer>(display_, config_, context_);
+  }
+  return *streamer_;
+}
+
+void context::capture_frames(capture::consumer consumer) {
+  capture_.reset();
+  if (consumer) {
+    capture_ = std::make_unique<capture>(std::move(consumer));
+  }
+}
+
+jobs& context::workers() {
+  if (!jobs_) {
+    jobs_ = std::make_unique<jobs>();
+  }
+  return *jobs_;
+}
+
+const std::vector<std::uint32_t>& context::cull(const math::frustum& frustum, const math::spheres& spheres) {
+  // Split into partitions of at least 16k spheres that start on a multiple of 8 for the vector kernels.
+  constexpr std::size_t minimum = 16 * 1024;
+  const auto count = spheres.size();
+  visible_.resize(count);
+  auto partitions = std::max<std::size_t>((count + minimum - 1) / minimum, 1);
+  if (partitions == 1) {
+    visible_.resize(math::cull(frustum, spheres, 0, count, visible_.data()));
+    return visible_;
+  }
+  partitions = std::min(partitions, workers().threads());
+  const auto size = ((count + partitions - 1) / partitions + 7) / 8 * 8;
+
+  // Each partition writes to its own range of the list. Move the ranges together afterwards.
+  std::vector<std::size_t> sizes(partitions);
+  workers().run(partitions, [&](std::size_t index) {
+    const auto first = std::min(index * size, count);
+    sizes[index] = math::cull(frustum, spheres, first, std::min(size, count - first), visible_.data() + first);
+  });
+  auto end = visible_.begin() + static_cast<std::ptrdiff_t>(sizes[0]);
+  for (std::size_t i = 1; i < partitions; i++) {
+    const auto first = visible_.begin() + static_cast<std::ptrdiff_t>(std::min(i * size, count));
+    end = std::copy(first, first + static_cast<std::ptrdiff_t>(sizes[i]), end);
+  }
+  visible_.erase(end, visible_.end());
+  return visible_;
+}
+
+context::view& context::create_view(GLsizei cx, GLsizei cy, EGLNativeWindowType window) {
+  auto view = std::make_unique<context::view>();
+  view->window_ = window;
+  view->cx_ = std::max(cx, 1);
+  view->cy_ = std::max(cy, 1);
+  create_surface(*view);
+  views_.push_back(std::move(view));
+  return *views_.back();
+}
+
+void context::resize_view(view& view, GLsizei cx, GLsizei cy) {
+  view.cx_ = std::max(cx, 1);
+  view.cy_ = std::max(cy, 1);
+  if (!view.window_) {
+    create_surface(view);
+  }
+}
+
+void context::destroy_view(view& view) noexcept {
+  const auto it = std::find_if(views_.begin(), views_.end(), [&](const auto& entry) { return entry.get() == &view; });
+  if (it == views_.end()) {
+    return;
+  }
+  if (view.surface_ != EGL_NO_SURFACE) {
+    eglDestroySurface(display_, view.surface_);
+  }
+  views_.erase(it);
+}
+
 void context::on_render() {
-  // Set framebuffer when multisampling is enabled.
-  if (samples_ > 1) {
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  profiler_.begin();
+
+  // Bound the latency by waiting for the frame that used this slot before.
+  if (auto& fence = fences_[frame_index()]) {
+    if (!fence.signaled()) {
+      GL_MARKER("wait");
+      fence.wait();
+      stalls_++;
+    }
+    fence = {};
+  }
+
+  // Start writing per-frame data into the segment of this slot, which the GPU finished reading.
+  if (stream_) {
+    stream_->begin_frame(frame_index());
+  }
+
+  // Shrink render targets when the size was stable for the quiet period.
+  if (shrink_ != std::chrono::steady_clock::time_point() && std::chrono::steady_clock::now() >= shrink_) {
+    create_targets(cx_, cy_, true);
+  }
+
+  // Set framebuffer when multisampling or dynamic resolution scaling is enabled.
+  auto scene = scene_.get();
+  if (resolution_) {
+    update_scale();
+    if (scaled_) {
+      scene = scaled_.get();
+    }
+    state_.viewport(0, 0, rx_, ry_);
+  }
+  framebuffer_ = scene ? scene->framebuffer() : target_;
+  state_.bind_framebuffer(GL_FRAMEBUFFER, framebuffer_);
+
+  // Publish streamed textures.
+  if (streamer_) {
+    streamer_->update();
   }
 
   // Render scene.
-  render();
+  {
+    GL_MARKER("render");
+    profiler::scope scope(profiler_, profiler::stage::render);
+    render();
+  }
 
-  // Unset framebuffer when multisampling is enabled.
-  if (samples_ > 1) {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glBlitFramebuffer(0, 0, cx_, cy_, 0, 0, cx_, cy_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  // Resolve multisampling and upscale the scene.
+  if (scene) {
+    GL_MARKER("resolve");
+    profiler::scope scope(profiler_, profiler::stage::resolve);
+    auto source = scene;
+    if (resolved_) {
+      // Multisampled framebuffers can only be blitted without scaling.
+      state_.bind_framebuffer(GL_READ_FRAMEBUFFER, scene->framebuffer());
+      state_.bind_framebuffer(GL_DRAW_FRAMEBUFFER, resolved_->framebuffer());
+      glBlitFramebuffer(0, 0, rx_, ry_, 0, 0, rx_, ry_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+      scene->invalidate();
+      source = resolved_.get();
+    }
+    const auto filter = rx_ == cx_ && ry_ == cy_ ? GL_NEAREST : GL_LINEAR;
+    state_.bind_framebuffer(GL_READ_FRAMEBUFFER, source->framebuffer());
+    state_.bind_framebuffer(GL_DRAW_FRAMEBUFFER, target_);
+    glBlitFramebuffer(0, 0, rx_, ry_, 0, 0, cx_, cy_, GL_COLOR_BUFFER_BIT, filter);
+
+    // The scene attachments are not needed after the resolve.
+    source->invalidate();
+  } else if (output_) {
+    output_->invalidate(false, true);
+  } else {
+    // Discard depth and stencil of the default framebuffer before presenting.
+    const GLenum attachments[] = { GL_DEPTH, GL_STENCIL };
+    state_.bind_framebuffer(GL_DRAW_FRAMEBUFFER, target_);
+    glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, 2, attachments);
+  }
+
+  // Read back the presented frame.
+  if (capture_) {
+    GL_MARKER("capture");
+    profiler::scope scope(profiler_, profiler::stage::capture);
+    capture_->read(target_, cx_, cy_, captured_++);
   }
 
   // Swap buffers.
-  eglSwapBuffers(display_, surface_);
+  {
+    GL_MARKER("present");
+    profiler::scope scope(profiler_, profiler::stage::present);
+    if (surface_ != EGL_NO_SURFACE) {
+      eglSwapBuffers(display_, surface_);
+    } else {
+      glFlush();
+    }
+  }
+
+  // Render additional views.
+  if (!views_.empty()) {
+    GL_MARKER("views");
+    render_views();
+  }
+
+  // Protect the resources of this slot until the GPU finished the frame.
+  fences_[frame_index()] = gl::fence(GL_SYNC_GPU_COMMANDS_COMPLETE);
+  frame_++;
+
+  profiler_.end();
+  state_.end_frame();
+  targets_.end_frame();
+
+  // Check for errors once per frame.
+  if (const auto ec = gl::check_frame()) {
+    throw gl::system_error(ec, "Could not render frame");
+  }
+}
+
+void context::update_scale() {
+  // Use the slower of the CPU and GPU times of the render and resolve stages of the newest frame.
+  profiler::record record;
+  if (profiler_.latest(record) && record.frame != resolution_frame_) {
+    resolution_frame_ = record.frame;
+    const auto render = static_cast<std::size_t>(profiler::stage::render);
+    const auto resolve = static_cast<std::size_t>(profiler::stage::resolve);
+    const auto cpu = record.cpu[render] + std::max(record.cpu[resolve], 0.0f);
+    const auto gpu = record.gpu[render] >= 0.0f ? record.gpu[render] + std::max(record.gpu[resolve], 0.0f) : 0.0f;
+    resolution_->update(std::max(cpu, gpu));
+  }
+
+  // Acquire targets for the quantized scale.
+  const auto scale = resolution_->scale();
+  rx_ = std::max(1, static_cast<GLsizei>(std::lround(cx_ * scale)));
+  ry_ = std::max(1, static_cast<GLsizei>(std::lround(cy_ * scale)));
+  if (rx_ == cx_ && ry_ == cy_) {
+    scaled_.reset();
+    resolved_.reset();
+    return;
+  }
+  const auto sx = round_up(rx_, bucket);
+  const auto sy = round_up(ry_, bucket);
+  if (!scaled_ || scaled_->info().cx != sx || scaled_->info().cy != sy) {
+    scaled_ = targets_.acquire({ sx, sy, format(), samples_, GL_DEPTH24_STENCIL8 });
+    resolved_.reset();
+    if (samples_ > 1) {
+      resolved_ = targets_.acquire({ sx, sy, format(), 0, GL_NONE });
+    }
+  }
+}
+
+void context::create_targets(GLsizei cx, GLsizei cy, bool shrink) {
+  // Keep the current allocation when the size fits and shrink it later when the size stays smaller.
+  const auto bx = round_up(cx, bucket);
+  const auto by = round_up(cy, bucket);
+  if (!shrink && ax_ && bx <= ax_ && by <= ay_) {
+    shrink_ = bx < ax_ || by < ay_ ? std::chrono::steady_clock::now() + quiet : std::chrono::steady_clock::time_point();
+    return;
+  }
+  shrink_ = {};
+  if (ax_ && !surfaceless_ && !native_window()) {
+    create_pbuffer(bx, by);
+  }
+  ax_ = bx;
+  ay_ = by;
+  if (surfaceless_) {
+    output_ = targets_.acquire({ bx, by, GL_RGBA8, 0, samples_ > 1 ? GLenum(GL_NONE) : GL_DEPTH24_STENCIL8 });
+    target_ = output_->framebuffer();
+  }
+  if (samples_ > 1) {
+    scene_ = targets_.acquire({ bx, by, format(), samples_, GL_DEPTH24_STENCIL8 });
+  }
+
+  // Targets with the previous size are no longer useful.
+  targets_.clear();
+}
+
+bool context::create_display(const std::string& name, bool headless) {
+  const auto extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (name == "default") {
+    display_ = eglGetDisplay(nateive_display());
+  } else if (name == "surfaceless") {
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    if (headless && has_extension(extensions, "EGL_MESA_platform_surfaceless")) {
+      display_ = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+#endif
+  } else {
+#ifdef EGL_PLATFORM_ANGLE_ANGLE
+    std::vector<EGLint> attributes;
+    if (name == "d3d11") {
+      attributes = {
+        EGL_PLATFORM_ANGLE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_TYPE_D3D11_ANGLE,
+        EGL_PLATFORM_ANGLE_DEVICE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_DEVICE_TYPE_HARDWARE_ANGLE,
+        EGL_PLATFORM_ANGLE_ENABLE_AUTOMATIC_TRIM_ANGLE, EGL_TRUE,
+      };
+    } else if (name == "vulkan") {
+      attributes = { EGL_PLATFORM_ANGLE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_TYPE_VULKAN_ANGLE };
+    } else if (name == "gl") {
+      attributes = { EGL_PLATFORM_ANGLE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_TYPE_OPENGL_ANGLE };
+    } else if (name == "gles") {
+      attributes = { EGL_PLATFORM_ANGLE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_TYPE_OPENGLES_ANGLE };
+#ifdef EGL_PLATFORM_ANGLE_DEVICE_TYPE_SWIFTSHADER_ANGLE
+    } else if (name == "swiftshader") {
+      // Use the SwiftShader software renderer through the Vulkan backend.
+      attributes = {
+        EGL_PLATFORM_ANGLE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_TYPE_VULKAN_ANGLE,
+        EGL_PLATFORM_ANGLE_DEVICE_TYPE_ANGLE, EGL_PLATFORM_ANGLE_DEVICE_TYPE_SWIFTSHADER_ANGLE,
+      };
+#endif
+    } else {
+      return false;
+    }
+#ifdef EGL_EXPERIMENTAL_PRESENT_PATH_ANGLE
+    // Prefer the fast present path and fall back to the copy present path when no config matches.
+    if (name == "d3d11" && settings().present_fast) {
+      auto fast = attributes;
+      fast.insert(fast.end(), { EGL_EXPERIMENTAL_PRESENT_PATH_ANGLE, EGL_EXPERIMENTAL_PRESENT_PATH_FAST_ANGLE, EGL_NONE });
+      display_ = get_platform_display(EGL_PLATFORM_ANGLE_ANGLE, reinterpret_cast<void*>(nateive_display()), fast.data());
+      if (display_ != EGL_NO_DISPLAY && eglInitialize(display_, nullptr, nullptr) && choose_config(headless)) {
+        return true;
+      }
+      if (display_ != EGL_NO_DISPLAY) {
+        eglTerminate(display_);
+        display_ = EGL_NO_DISPLAY;
+      }
+    }
+    if (name == "d3d11") {
+      attributes.insert(attributes.end(), { EGL_EXPERIMENTAL_PRESENT_PATH_ANGLE, EGL_EXPERIMENTAL_PRESENT_PATH_COPY_ANGLE });
+    }
+#endif
+    attributes.push_back(EGL_NONE);
+    display_ = get_platform_display(EGL_PLATFORM_ANGLE_ANGLE, reinterpret_cast<void*>(nateive_display()), attributes.data());
+#endif
+  }
+  if (display_ == EGL_NO_DISPLAY) {
+    return false;
+  }
+  if (!eglInitialize(display_, nullptr, nullptr) || !choose_config(headless)) {
+    eglTerminate(display_);
+    display_ = EGL_NO_DISPLAY;
+    return false;
+  }
+  return true;
+}
+
+bool context::choose_config(bool headless) {
+  // The surface keeps a depth buffer even when multisampling is requested, since the sample count is only
+  // limited to what the implementation supports after the context was created. The scene renders directly
+  // into the surface when multisampling ends up disabled.
+  EGLint config_count = 0;
+  const auto choose = [&](EGLint surface_type) {
+    const EGLint attributes[] = {
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+      EGL_CONFORMANT, EGL_OPENGL_ES3_BIT,
+      EGL_SURFACE_TYPE, surface_type,
+      EGL_RED_SIZE, 8,
+      EGL_GREEN_SIZE, 8,
+      EGL_BLUE_SIZE, 8,
+      EGL_ALPHA_SIZE, headless ? 8 : 0,
+      EGL_DEPTH_SIZE, 24,
+      EGL_STENCIL_SIZE, 8,
+      EGL_NONE
+    };
+    if (!eglChooseConfig(display_, attributes, &config_, 1, &config_count)) {
+      config_count = 0;
+    }
+  };
+  surfaceless_ = false;
+
+  // Prefer configs that support both window and pbuffer views, and fall back to the main surface type.
+  choose(EGL_WINDOW_BIT | EGL_PBUFFER_BIT);
+  if (config_count < 1) {
+    choose(headless ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT);
+  }
+  if (config_count < 1 && headless && has_extension(eglQueryString(display_, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+    // Render into an offscreen framebuffer when the display has no pbuffer configs.
+    surfaceless_ = true;
+    choose(0);
+  }
+  return config_count > 0;
+}
+
+void context::create_pbuffer(GLsizei cx, GLsizei cy) {
+  // Pbuffer surfaces can not be resized and must be recreated.
+  const EGLint attributes[] = {
+    EGL_WIDTH, cx,
+    EGL_HEIGHT, cy,
+    EGL_NONE
+  };
+  const auto surface = eglCreatePbufferSurface(display_, config_, attributes);
+  if (surface == EGL_NO_SURFACE) {
+    throw egl::system_error(egl::error(), "Could not create OpenGL ES pbuffer surface");
+  }
+  if (context_ != EGL_NO_CONTEXT && !eglMakeCurrent(display_, surface, surface, context_)) {
+    eglDestroySurface(display_, surface);
+    throw egl::system_error(egl::error(), "Could not attach OpenGL ES context");
+  }
+  if (surface_ != EGL_NO_SURFACE) {
+    eglDestroySurface(display_, surface_);
+  }
+  surface_ = surface;
+}
+
+void context::create_surface(view& view) {
+  // Offscreen views render into a target from the pool in surfaceless mode or when the config has no pbuffer support.
+  EGLint surface_type = 0;
+  if (!surfaceless_ && !eglGetConfigAttrib(display_, config_, EGL_SURFACE_TYPE, &surface_type)) {
+    surface_type = 0;
+  }
+  if (!view.window_ && !(surface_type & EGL_PBUFFER_BIT)) {
+    view.target_ = targets_.acquire({ view.cx_, view.cy_, GL_RGBA8, 0, GL_DEPTH24_STENCIL8 });
+    return;
+  }
+  if (view.window_ && !(surface_type & EGL_WINDOW_BIT)) {
+    throw gl::runtime_error("The OpenGL ES config does not support window views.");
+  }
+  EGLSurface surface = EGL_NO_SURFACE;
+  if (view.window_) {
+    surface = eglCreateWindowSurface(display_, config_, view.window_, nullptr);
+  } else {
+    const EGLint attributes[] = {
+      EGL_WIDTH, view.cx_,
+      EGL_HEIGHT, view.cy_,
+      EGL_NONE
+    };
+    surface = eglCreatePbufferSurface(display_, config_, attributes);
+  }
+  if (surface == EGL_NO_SURFACE) {
+    throw egl::system_error(egl::error(), "Could not create OpenGL ES view surface");
+  }
+  if (view.surface_ != EGL_NO_SURFACE) {
+    eglDestroySurface(display_, view.surface_);
+  }
+  view.surface_ = surface;
+
+  // The main view paces the frame.
+  if (view.window_ && eglMakeCurrent(display_, surface, surface, context_)) {
+    eglSwapInterval(display_, 0);
+  }
+  if (!eglMakeCurrent(display_, surface_, surface_, context_)) {
+    throw egl::system_error(egl::error(), "Could not attach OpenGL ES context");
+  }
+}
+
+void context::render_views() {
+  const auto viewport = state_.viewport();
+  for (const auto& view : views_) {
+    if (view->surface_ != EGL_NO_SURFACE && !eglMakeCurrent(display_, view->surface_, view->surface_, context_)) {
+      throw egl::system_error(egl::error(), "Could not attach OpenGL ES context to view");
+    }
+    framebuffer_ = view->framebuffer();
+    state_.bind_framebuffer(GL_FRAMEBUFFER, framebuffer_);
+    state_.viewport(0, 0, view->cx_, view->cy_);
+    render_view(*view);
+    if (view->surface_ != EGL_NO_SURFACE) {
+      eglSwapBuffers(display_, view->surface_);
+    }
+  }
+
+  // Restore the main surface, framebuffer and viewport.
+  if (!eglMakeCurrent(display_, surface_, surface_, context_)) {
+    throw egl::system_error(egl::error(), "Could not attach OpenGL ES context");
+  }
+  framebuffer_ = target_;
+  state_.bind_framebuffer(GL_FRAMEBUFFER, framebuffer_);
+  if (viewport[2] >= 0) {
+    state_.viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+  }
+  glFlush();
+}
+
+GLenum context::format() const noexcept {
+  // Multisample resolve blits require identical read and draw buffer formats.
+  // Headless configs request an alpha channel, since most implementations can't match RGBX pbuffers.
+#ifdef EGL_PLATFORM_ANGLE_ANGLE
+  if (native_window()) {
+    return GL_BGRA8_EXT;
+  }
+#endif
+  return GL_RGBA8;
 }
@@ -1,6 +1,23 @@
 #pragma once
+#include <capture.h>
+#include <gl/cache.h>
+#include <gl/fence.h>
+#include <gl/state.h>
+#include <gl/stream.h>
+#include <gl/target.h>
+#include <jobs.h>
+#include <math/cull.h>
+#include <profiler.h>
+#include <resolution.h>
+#include <streamer.h>
 #include <window.h>
 #include <GLES3/gl3.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 class context : public window {
 public:
@@ -11,20 +28,208 @@ public:
   virtual void destroy() = 0;
   virtual void render() = 0;
 
+  // Additional output rendered with this context after the main view.
+  //
+  // Views are window or pbuffer surfaces created from the same display and config. They are drawn with the
+  // context that draws the main view, so programs, buffers, textures and even vertex arrays and framebuffers
+  // are created once and used for all views. Offscreen views are render targets when the config has no
+  // pbuffer support. Window views require a config with window support, which headless displays usually
+  // lack. Views are presented without multisampling and without vsync.
+  class view {
+  public:
+    GLsizei cx() const noexcept {
+      return cx_;
+    }
+
+    GLsizei cy() const noexcept {
+      return cy_;
+    }
+
+    // Returns the native window or an empty handle for offscreen views.
+    EGLNativeWindowType native_window() const noexcept {
+      return window_;
+    }
+
+    // Returns the surface or EGL_NO_SURFACE for offscreen targets.
+    EGLSurface surface() const noexcept {
+      return surface_;
+    }
+
+    // Returns the framebuffer to read from or draw into. 0 for window and pbuffer surfaces.
+    GLuint framebuffer() const noexcept {
+      return target_ ? target_->framebuffer() : 0;
+    }
+
+  private:
+    friend class context;
+
+    EGLNativeWindowType window_ = {};
+    EGLSurface surface_ = EGL_NO_SURFACE;
+    std::shared_ptr<gl::target> target_;
+    GLsizei cx_ = 0;
+    GLsizei cy_ = 0;
+  };
+
+  // Called for each view after the main view was presented. The view framebuffer is bound
+  // and the viewport covers the view.
+  virtual void render_view(view& view) {}
+
   void on_create(GLsizei cx, GLsizei cy, GLint dpi) override;
   void on_resize(GLsizei cx, GLsizei cy, GLint dpi) override;
   void on_destroy() override;
   void on_render() override;
 
+  // Returns the frame timings of the render thread.
+  const profiler& profiling() const noexcept {
+    return profiler_;
+  }
+
+  // Returns the binding state of the context.
+  gl::state& state() noexcept {
+    return state_;
+  }
+
+  // Returns the program binary cache. Disabled unless a cache directory was specified.
+  const gl::cache& shader_cache() const noexcept {
+    return cache_;
+  }
+
+  // Returns the size of the scene target, which is smaller than the client size when dynamic resolution
+  // scaling reduced the scale. With dynamic resolution, the viewport is set to this size before each render().
+  GLsizei render_cx() const noexcept {
+    return rx_;
+  }
+
+  GLsizei render_cy() const noexcept {
+    return ry_;
+  }
+
+  // Returns the framebuffer that render() and render_view() draw into (e.g. for gl::queue packets).
+  GLuint framebuffer() const noexcept {
+    return framebuffer_;
+  }
+
+  // Returns the number of frames the CPU may run ahead of the GPU.
+  std::size_t frames_in_flight() const noexcept {
+    return fences_.size();
+  }
+
+  // Returns the slot of the current frame in [0, frames_in_flight()). Resources written by the CPU once per
+  // frame (e.g. an element of a gl::uniform_buffer) should be indexed by the slot. on_render() waits until
+  // the GPU finished the frame that used the slot before, so the slot is never written while it is read.
+  std::size_t frame_index() const noexcept {
+    return frame_ % fences_.size();
+  }
+
+  // Returns the number of frames rendered before the current one.
+  std::uint64_t frame_number() const noexcept {
+    return frame_;
+  }
+
+  // Returns the name of the backend that was chosen from the fallback chain.
+  const std::string& backend() const noexcept {
+    return backend_;
+  }
+
+  // Size of a frame segment of the stream buffer.
+  static constexpr GLsizeiptr stream_capacity = 2 * 1024 * 1024;
+
+  // Returns the stream buffer for data written once per frame (e.g. uniform blocks and instance data). The
+  // buffer is created on first use with stream_capacity bytes for each frame in flight. on_render() starts
+  // the segment of the current frame slot before render(), so regions can be mapped during render() and
+  // render_view() without further synchronization.
+  gl::stream& stream();
+
+  // Returns the texture streamer. The upload context and threads are created on first use.
+  // Textures that finished uploading are published before each call to render().
+  streamer& textures();
+
+  // Returns the worker pool for recording command lists and other data parallel work on the render thread.
+  // The worker threads are created on first use.
+  jobs& workers();
+
+  // Culls the bounding spheres against the frustum before draw submission and returns the indices of the
+  // visible spheres in ascending order. Large counts are partitioned across the workers(). The returned list
+  // is valid until the next call.
+  const std::vector<std::uint32_t>& cull(const math::frustum& frustum, const math::spheres& spheres);
+
+  // Creates a view for the native window or an offscreen view when the window handle is empty.
+  // Throws when the config does not support window surfaces. Must be called with a current context. The view is
+  // valid until destroy_view() or on_destroy().
+  view& create_view(GLsizei cx, GLsizei cy, EGLNativeWindowType window = {});
+
+  // Resizes the view. Pbuffer surfaces and offscreen targets are recreated.
+  void resize_view(view& view, GLsizei cx, GLsizei cy);
+
+  void destroy_view(view& view) noexcept;
+
+  // Reads back every presented frame asynchronously and hands it to the consumer on a worker thread.
+  // Replaces the capture configured on the command line. An empty consumer stops capturing.
+  void capture_frames(capture::consumer consumer);
+
 private:
+  bool create_display(const std::string& name, bool headless);
+  bool choose_config(bool headless);
+  void create_pbuffer(GLsizei cx, GLsizei cy);
+  void create_surface(view& view);
+  void render_views();
+  void create_targets(GLsizei cx, GLsizei cy, bool shrink = false);
+  void update_scale();
+  GLenum format() const noexcept;
+
   EGLDisplay display_ = EGL_NO_DISPLAY;
   EGLSurface surface_ = EGL_NO_SURFACE;
   EGLContext context_ = EGL_NO_CONTEXT;
+  EGLConfig config_ = {};
+  std::string backend_;
+
+  // Offscreen target used instead of the default framebuffer in surfaceless mode.
+  bool surfaceless_ = false;
+  std::shared_ptr<gl::target> output_;
+  GLuint target_ = 0;
+
+  // Framebuffer bound for render() or render_view().
+  GLuint framebuffer_ = 0;
+
+  // Multisampled scene target. Resolved into the output target after rendering.
+  GLsizei samples_ = 0;
+  std::shared_ptr<gl::target> scene_;
+  gl::targets targets_;
 
-  GLsizei samples_ = 4;
-  GLuint rbo_ = 0;
-  GLuint fbo_ = 0;
+  // Render targets and headless pbuffers are allocated in size buckets and rendered into with a sub-viewport.
+  // Larger allocations are kept until the size was stable for the quiet period, so that interactive resizing
+  // does not reallocate.
+  static constexpr GLsizei bucket = 128;
+  static constexpr std::chrono::milliseconds quiet{ 500 };
+  GLsizei ax_ = 0;
+  GLsizei ay_ = 0;
+  std::chrono::steady_clock::time_point shrink_ = {};
 
   GLsizei cx_ = 1;
   GLsizei cy_ = 1;
+
+  // Dynamic resolution scaling with the scaled scene target and its resolved copy when multisampling is enabled.
+  std::optional<resolution> resolution_;
+  std::uint64_t resolution_frame_ = 0;
+  std::shared_ptr<gl::target> scaled_;
+  std::shared_ptr<gl::target> resolved_;
+  GLsizei rx_ = 1;
+  GLsizei ry_ = 1;
+
+  std::vector<std::unique_ptr<view>> views_;
+
+  // Fence of the last frame that used each slot and the number of frames that had to wait for one.
+  std::vector<gl::fence> fences_;
+  std::uint64_t frame_ = 0;
+  std::uint64_t stalls_ = 0;
+
+  profiler profiler_;
+  gl::cache cache_;
+  gl::state state_;
+  std::unique_ptr<gl::stream> stream_;
+  std::unique_ptr<streamer> streamer_;
+  std::unique_ptr<jobs> jobs_;
+  std::vector<std::uint32_t> visible_;
+  std::unique_ptr<capture> capture_;
+  std::uint64_t captured_ = 0;
 };
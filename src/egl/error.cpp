@@ -1,4 +1,4 @@
-#include <gl/error.h>
+#include <egl/error.h>
 #include <EGL/egl.h>
 #include <string>
 
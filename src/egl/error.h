@@ -16,7 +16,7 @@ public:
 
 class system_error : public std::system_error {
 public:
-  std::system_error::system_error;
+  using std::system_error::system_error;
 };
 
 }  // namespace egl
@@ -1,7 +1,10 @@
 #pragma once
 #include <gl/error.h>
 #include <gl/resource.h>
+#include <gl/state.h>
+#include <gl/vertex.h>
 #include <memory>
+#include <utility>
 
 namespace gl {
 
@@ -11,15 +14,16 @@ public:
 
   explicit arrays(std::size_t size) : handles_(std::make_unique<GLuint[]>(size)), size_(size) {
     glGenVertexArrays(static_cast<GLsizei>(size_), handles_.get());
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not generate vertex array object names");
     }
   }
 
-  arrays(arrays&& other) noexcept : size_(std::exchange(other.size_, 0)), handles_(std::move(other.handles_)) {}
+  arrays(arrays&& other) noexcept : handles_(std::move(other.handles_)), size_(std::exchange(other.size_, 0)) {}
 
   arrays& operator=(arrays&& other) noexcept {
     if (handles_) {
+      state::forget_arrays(static_cast<GLsizei>(size_), handles_.get());
       glDeleteVertexArrays(static_cast<GLsizei>(size_), handles_.get());
     }
     size_ = std::exchange(other.size_, 0);
@@ -29,6 +33,7 @@ public:
 
   ~arrays() {
     if (handles_) {
+      state::forget_arrays(static_cast<GLsizei>(size_), handles_.get());
       glDeleteVertexArrays(static_cast<GLsizei>(size_), handles_.get());
     }
   }
@@ -40,6 +45,36 @@ public:
     return handles_[index];
   }
 
+  // Sets up the vertex array object at the given index for the vertex layout of the Vertex type. Attributes
+  // that are not active in the program are skipped. The element buffer is only bound when it is not 0.
+  template <typename Vertex>
+  void layout(std::size_t index, GLuint program, GLuint buffer, GLuint elements = 0) const {
+    static_assert(vertex_layout_valid<Vertex>(), "Vertex attributes must be 4 byte aligned and inside the vertex.");
+    bind_vertex_array(at(index));
+    bind_buffer(GL_ARRAY_BUFFER, buffer);
+    if (elements) {
+      bind_buffer(GL_ELEMENT_ARRAY_BUFFER, elements);
+    }
+    constexpr auto stride = static_cast<GLsizei>(sizeof(Vertex));
+    for (const auto& attribute : vertex_layout<Vertex>::attributes) {
+      const auto location = glGetAttribLocation(program, attribute.name);
+      if (location < 0) {
+        continue;
+      }
+      const auto offset = reinterpret_cast<const void*>(attribute.offset);
+      glEnableVertexAttribArray(static_cast<GLuint>(location));
+      if (attribute.integer) {
+        glVertexAttribIPointer(static_cast<GLuint>(location), attribute.size, attribute.type, stride, offset);
+      } else {
+        glVertexAttribPointer(static_cast<GLuint>(location), attribute.size, attribute.type, attribute.normalized,
+          stride, offset);
+      }
+    }
+    if (const auto ec = check()) {
+      throw system_error(ec, "Could not set vertex array layout");
+    }
+  }
+
   GLuint operator[](std::size_t index) const noexcept {
     return handles_[index];
   }
@@ -1,7 +1,9 @@
 #pragma once
 #include <gl/error.h>
 #include <gl/resource.h>
+#include <gl/state.h>
 #include <memory>
+#include <utility>
 
 namespace gl {
 
@@ -11,15 +13,16 @@ public:
 
   explicit buffers(std::size_t size) : handles_(std::make_unique<GLuint[]>(size)), size_(size) {
     glGenBuffers(static_cast<GLsizei>(size_), handles_.get());
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not generate buffer object names");
     }
   }
 
-  buffers(buffers&& other) noexcept : size_(std::exchange(other.size_, 0)), handles_(std::move(other.handles_)) {}
+  buffers(buffers&& other) noexcept : handles_(std::move(other.handles_)), size_(std::exchange(other.size_, 0)) {}
 
   buffers& operator=(buffers&& other) noexcept {
     if (handles_) {
+      state::forget_buffers(static_cast<GLsizei>(size_), handles_.get());
       glDeleteBuffers(static_cast<GLsizei>(size_), handles_.get());
     }
     size_ = std::exchange(other.size_, 0);
@@ -29,6 +32,7 @@ public:
 
   ~buffers() {
     if (handles_) {
+      state::forget_buffers(static_cast<GLsizei>(size_), handles_.get());
       glDeleteBuffers(static_cast<GLsizei>(size_), handles_.get());
     }
   }
@@ -0,0 +1,169 @@
+#include <gl/cache.h>
+#include <gl/error.h>
+#include <GLES2/gl2ext.h>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <system_error>
+#include <vector>
+
+namespace gl {
+namespace {
+
+constexpr std::uint32_t magic = 0x43424C47;  // "GLBC"
+constexpr std::uint32_t version = 1;
+
+struct header {
+  std::uint32_t magic = 0;
+  std::uint32_t version = 0;
+  std::uint64_t key = 0;
+  std::uint64_t checksum = 0;
+  std::uint32_t format = 0;
+  std::uint32_t size = 0;
+};
+
+// FNV-1a hash.
+std::uint64_t hash(std::string_view data, std::uint64_t value = 0xCBF29CE484222325) noexcept {
+  for (const auto c : data) {
+    value ^= static_cast<unsigned char>(c);
+    value *= 0x100000001B3;
+  }
+  return value;
+}
+
+struct file_deleter {
+  void operator()(std::FILE* file) const noexcept {
+    std::fclose(file);
+  }
+};
+
+using file_ptr = std::unique_ptr<std::FILE, file_deleter>;
+
+std::string string(GLenum name) {
+  const auto value = reinterpret_cast<const char*>(glGetString(name));
+  return value ? value : "";
+}
+
+}  // namespace
+
+cache::cache(std::filesystem::path directory) {
+  // Disable the cache when the implementation does not support program binaries.
+  GLint formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  if (directory.empty() || formats < 1) {
+    return;
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  if (ec) {
+    return;
+  }
+  directory_ = std::move(directory);
+  driver_ = string(GL_VENDOR) + '\n' + string(GL_RENDERER) + '\n' + string(GL_VERSION);
+}
+
+std::uint64_t cache::key(std::string_view vert, std::string_view frag) const noexcept {
+  auto value = hash(vert);
+  value = hash({ "\0", 1 }, value);
+  value = hash(frag, value);
+  value = hash({ "\0", 1 }, value);
+  return hash(driver_, value);
+}
+
+bool cache::load(GLuint program, std::uint64_t key) const noexcept {
+  if (directory_.empty()) {
+    return false;
+  }
+  try {
+    file_ptr file(std::fopen(this->file(key).string().data(), "rb"));
+    if (!file) {
+      return false;
+    }
+    header header;
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1) {
+      return false;
+    }
+    if (header.magic != magic || header.version != version || header.key != key) {
+      return false;
+    }
+    std::string binary;
+    binary.resize(header.size);
+    if (std::fread(binary.data(), 1, binary.size(), file.get()) != binary.size() || hash(binary) != header.checksum) {
+      return false;
+    }
+    glProgramBinary(program, static_cast<GLenum>(header.format), binary.data(), static_cast<GLsizei>(binary.size()));
+  }
+  catch (...) {
+    return false;
+  }
+
+  // The driver rejects binaries it can not use (e.g. after an update) by failing the link.
+  GLint success = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  return success == GL_TRUE && !check();
+}
+
+void cache::store(GLuint program, std::uint64_t key) const noexcept {
+  if (directory_.empty()) {
+    return;
+  }
+  try {
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size < 1) {
+      return;
+    }
+    std::string binary;
+    binary.resize(static_cast<std::size_t>(size));
+    GLenum format = 0;
+    glGetProgramBinary(program, size, &size, &format, binary.data());
+    if (check()) {
+      return;
+    }
+    binary.resize(static_cast<std::size_t>(size));
+
+    header header;
+    header.magic = magic;
+    header.version = version;
+    header.key = key;
+    header.checksum = hash(binary);
+    header.format = static_cast<std::uint32_t>(format);
+    header.size = static_cast<std::uint32_t>(binary.size());
+
+    // Write to a uniquely named temporary file and rename it, so that concurrent processes never read
+    // partial entries or write to the same temporary file.
+    std::random_device random;
+    char suffix[32] = {};
+    std::snprintf(suffix, sizeof(suffix), ".%08x%08x.tmp", random(), random());
+    const auto path = this->file(key);
+    auto temp = path;
+    temp += suffix;
+    {
+      file_ptr file(std::fopen(temp.string().data(), "wb"));
+      if (!file) {
+        return;
+      }
+      if (std::fwrite(&header, sizeof(header), 1, file.get()) != 1 ||
+          std::fwrite(binary.data(), 1, binary.size(), file.get()) != binary.size()) {
+        file.reset();
+        std::filesystem::remove(temp);
+        return;
+      }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+      std::filesystem::remove(temp, ec);
+    }
+  }
+  catch (...) {
+  }
+}
+
+std::filesystem::path cache::file(std::uint64_t key) const {
+  char name[32] = {};
+  std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+  return directory_ / name;
+}
+
+}  // namespace gl
@@ -0,0 +1,42 @@
+#pragma once
+#include <GLES3/gl3.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace gl {
+
+// On-disk program binary cache.
+//
+// Entries are keyed by a hash of the shader sources and the vendor, renderer and version strings of the
+// current context, so driver and backend changes invalidate them. Invalid entries are ignored and the
+// program is compiled from source instead. A default constructed cache is disabled.
+class cache {
+public:
+  cache() noexcept = default;
+
+  // Must be called with a current context.
+  explicit cache(std::filesystem::path directory);
+
+  // Computes the cache key for the given program sources.
+  std::uint64_t key(std::string_view vert, std::string_view frag) const noexcept;
+
+  // Loads the program binary. Returns false if there is no valid entry for the key.
+  bool load(GLuint program, std::uint64_t key) const noexcept;
+
+  // Stores the program binary. The program must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+  void store(GLuint program, std::uint64_t key) const noexcept;
+
+  explicit operator bool() const noexcept {
+    return !directory_.empty();
+  }
+
+private:
+  std::filesystem::path file(std::uint64_t key) const;
+
+  std::filesystem::path directory_;
+  std::string driver_;
+};
+
+}  // namespace gl
@@ -0,0 +1,355 @@
+#include <gl/commands.h>
+#include <gl/state.h>
+#include <algorithm>
+#include <cstring>
+
+namespace gl {
+
+enum class commands::op : std::uint32_t {
+  use_program,
+  bind_vertex_array,
+  bind_buffer,
+  bind_buffer_range,
+  bind_texture,
+  bind_framebuffer,
+  enable,
+  viewport,
+  vertex_attrib_ipointer,
+  uniform1i,
+  uniform1f,
+  uniform2fv,
+  uniform3fv,
+  uniform4fv,
+  uniform_matrix4fv,
+  buffer_sub_data,
+  draw_arrays,
+  draw_elements,
+};
+
+// Commands are stored as a header followed by the arguments and the copied data.
+struct commands::header {
+  op code;
+  std::uint32_t size;
+};
+
+namespace {
+
+constexpr std::size_t alignment = alignof(std::max_align_t);
+
+struct name_arguments {
+  GLenum target;
+  GLuint name;
+};
+
+struct range_arguments {
+  GLenum target;
+  GLuint index;
+  GLuint buffer;
+  GLintptr offset;
+  GLsizeiptr size;
+};
+
+struct texture_arguments {
+  GLuint unit;
+  GLenum target;
+  GLuint texture;
+};
+
+struct viewport_arguments {
+  GLint x;
+  GLint y;
+  GLsizei cx;
+  GLsizei cy;
+};
+
+struct attribute_arguments {
+  GLuint index;
+  GLint size;
+  GLenum type;
+  GLsizei stride;
+  GLuint buffer;
+  GLuint divisor;
+  GLintptr offset;
+};
+
+struct uniform_arguments {
+  GLint location;
+  GLsizei count;
+  union {
+    GLint i;
+    GLfloat f;
+  };
+};
+
+struct buffer_arguments {
+  GLenum target;
+  GLuint buffer;
+  GLintptr offset;
+  GLsizeiptr size;
+};
+
+struct draw_arguments {
+  GLenum mode;
+  GLint first;
+  GLsizei count;
+  GLenum type;
+  GLintptr offset;
+  GLsizei instances;
+};
+
+template <typename T>
+const T& arguments(const void* payload) noexcept {
+  return *static_cast<const T*>(payload);
+}
+
+const GLfloat* values(const void* payload) noexcept {
+  return reinterpret_cast<const GLfloat*>(static_cast<const std::byte*>(payload) + sizeof(uniform_arguments));
+}
+
+}  // namespace
+
+void commands::use_program(GLuint program) {
+  *static_cast<name_arguments*>(push(op::use_program, sizeof(name_arguments))) = { GL_NONE, program };
+}
+
+void commands::bind_vertex_array(GLuint array) {
+  *static_cast<name_arguments*>(push(op::bind_vertex_array, sizeof(name_arguments))) = { GL_NONE, array };
+}
+
+void commands::bind_buffer(GLenum target, GLuint buffer) {
+  *static_cast<name_arguments*>(push(op::bind_buffer, sizeof(name_arguments))) = { target, buffer };
+}
+
+void commands::bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+  *static_cast<range_arguments*>(push(op::bind_buffer_range, sizeof(range_arguments))) = {
+    target, index, buffer, offset, size
+  };
+}
+
+void commands::bind_texture(GLuint unit, GLenum target, GLuint texture) {
+  *static_cast<texture_arguments*>(push(op::bind_texture, sizeof(texture_arguments))) = { unit, target, texture };
+}
+
+void commands::bind_framebuffer(GLenum target, GLuint framebuffer) {
+  *static_cast<name_arguments*>(push(op::bind_framebuffer, sizeof(name_arguments))) = { target, framebuffer };
+}
+
+void commands::enable(GLenum capability, bool enable) {
+  *static_cast<name_arguments*>(push(op::enable, sizeof(name_arguments))) = { capability, enable ? 1U : 0U };
+}
+
+void commands::viewport(GLint x, GLint y, GLsizei cx, GLsizei cy) {
+  *static_cast<viewport_arguments*>(push(op::viewport, sizeof(viewport_arguments))) = { x, y, cx, cy };
+}
+
+void commands::vertex_attrib_ipointer(GLuint index, GLint size, GLenum type, GLsizei stride, GLuint buffer,
+  GLintptr offset, GLuint divisor) {
+  *static_cast<attribute_arguments*>(push(op::vertex_attrib_ipointer, sizeof(attribute_arguments))) = {
+    index, size, type, stride, buffer, divisor, offset
+  };
+}
+
+void commands::uniform(GLint location, GLint value) {
+  auto& arguments = *static_cast<uniform_arguments*>(push(op::uniform1i, sizeof(uniform_arguments)));
+  arguments.location = location;
+  arguments.count = 1;
+  arguments.i = value;
+}
+
+void commands::uniform(GLint location, GLfloat value) {
+  auto& arguments = *static_cast<uniform_arguments*>(push(op::uniform1f, sizeof(uniform_arguments)));
+  arguments.location = location;
+  arguments.count = 1;
+  arguments.f = value;
+}
+
+void commands::uniform2(GLint location, const GLfloat* values, GLsizei count) {
+  const auto bytes = sizeof(GLfloat) * 2 * static_cast<std::size_t>(count);
+  auto& arguments = *static_cast<uniform_arguments*>(push(op::uniform2fv, sizeof(uniform_arguments), bytes, values));
+  arguments.location = location;
+  arguments.count = count;
+}
+
+void commands::uniform3(GLint location, const GLfloat* values, GLsizei count) {
+  const auto bytes = sizeof(GLfloat) * 3 * static_cast<std::size_t>(count);
+  auto& arguments = *static_cast<uniform_arguments*>(push(op::uniform3fv, sizeof(uniform_arguments), bytes, values));
+  arguments.location = location;
+  arguments.count = count;
+}
+
+void commands::uniform4(GLint location, const GLfloat* values, GLsizei count) {
+  const auto bytes = sizeof(GLfloat) * 4 * static_cast<std::size_t>(count);
+  auto& arguments = *static_cast<uniform_arguments*>(push(op::uniform4fv, sizeof(uniform_arguments), bytes, values));
+  arguments.location = location;
+  arguments.count = count;
+}
+
+void commands::uniform_matrix4(GLint location, const GLfloat* values, GLsizei count) {
+  const auto bytes = sizeof(GLfloat) * 16 * static_cast<std::size_t>(count);
+  auto& arguments = *static_cast<uniform_arguments*>(
+    push(op::uniform_matrix4fv, sizeof(uniform_arguments), bytes, values));
+  arguments.location = location;
+  arguments.count = count;
+}
+
+void commands::buffer_sub_data(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) {
+  *static_cast<buffer_arguments*>(push(op::buffer_sub_data, sizeof(buffer_arguments), static_cast<std::size_t>(size),
+    data)) = { target, buffer, offset, size };
+}
+
+void commands::draw_arrays(GLenum mode, GLint first, GLsizei count) {
+  draw_arrays_instanced(mode, first, count, 0);
+}
+
+void commands::draw_arrays_instanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+  *static_cast<draw_arguments*>(push(op::draw_arrays, sizeof(draw_arguments))) = {
+    mode, first, count, GL_NONE, 0, instances
+  };
+}
+
+void commands::draw_elements(GLenum mode, GLsizei count, GLenum type, GLintptr offset) {
+  draw_elements_instanced(mode, count, type, offset, 0);
+}
+
+void commands::draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLsizei instances) {
+  *static_cast<draw_arguments*>(push(op::draw_elements, sizeof(draw_arguments))) = {
+    mode, 0, count, type, offset, instances
+  };
+}
+
+void commands::replay() const {
+  for (std::size_t i = 0; i < chunks_.size() && i <= chunk_; i++) {
+    const auto& chunk = chunks_[i];
+    for (std::size_t offset = 0; offset < chunk.size;) {
+      const auto& command = *reinterpret_cast<const header*>(chunk.data.get() + offset);
+      const auto payload = chunk.data.get() + offset + sizeof(header);
+      offset += command.size;
+      switch (command.code) {
+      case op::use_program:
+        gl::use_program(arguments<name_arguments>(payload).name);
+        break;
+      case op::bind_vertex_array:
+        gl::bind_vertex_array(arguments<name_arguments>(payload).name);
+        break;
+      case op::bind_buffer: {
+        const auto& a = arguments<name_arguments>(payload);
+        gl::bind_buffer(a.target, a.name);
+      } break;
+      case op::bind_buffer_range: {
+        const auto& a = arguments<range_arguments>(payload);
+        gl::bind_buffer_range(a.target, a.index, a.buffer, a.offset, a.size);
+      } break;
+      case op::bind_texture: {
+        const auto& a = arguments<texture_arguments>(payload);
+        gl::bind_texture(a.unit, a.target, a.texture);
+      } break;
+      case op::bind_framebuffer: {
+        const auto& a = arguments<name_arguments>(payload);
+        gl::bind_framebuffer(a.target, a.name);
+      } break;
+      case op::enable: {
+        const auto& a = arguments<name_arguments>(payload);
+        gl::enable(a.target, a.name != 0);
+      } break;
+      case op::viewport: {
+        const auto& a = arguments<viewport_arguments>(payload);
+        gl::viewport(a.x, a.y, a.cx, a.cy);
+      } break;
+      case op::vertex_attrib_ipointer: {
+        const auto& a = arguments<attribute_arguments>(payload);
+        gl::bind_buffer(GL_ARRAY_BUFFER, a.buffer);
+        glEnableVertexAttribArray(a.index);
+        glVertexAttribIPointer(a.index, a.size, a.type, a.stride, reinterpret_cast<const void*>(a.offset));
+        glVertexAttribDivisor(a.index, a.divisor);
+      } break;
+      case op::uniform1i: {
+        const auto& a = arguments<uniform_arguments>(payload);
+        glUniform1i(a.location, a.i);
+      } break;
+      case op::uniform1f: {
+        const auto& a = arguments<uniform_arguments>(payload);
+        glUniform1f(a.location, a.f);
+      } break;
+      case op::uniform2fv: {
+        const auto& a = arguments<uniform_arguments>(payload);
+        glUniform2fv(a.location, a.count, values(payload));
+      } break;
+      case op::uniform3fv: {
+        const auto& a = arguments<uniform_arguments>(payload);
+        glUniform3fv(a.location, a.count, values(payload));
+      } break;
+      case op::uniform4fv: {
+        const auto& a = arguments<uniform_arguments>(payload);
+        glUniform4fv(a.location, a.count, values(payload));
+      } break;
+      case op::uniform_matrix4fv: {
+        const auto& a = arguments<uniform_arguments>(payload);
+        glUniformMatrix4fv(a.location, a.count, GL_FALSE, values(payload));
+      } break;
+      case op::buffer_sub_data: {
+        // Binding an element array buffer would replace the one of the bound vertex array.
+        const auto& a = arguments<buffer_arguments>(payload);
+        const auto target = a.target == GL_ELEMENT_ARRAY_BUFFER ? GLenum(GL_COPY_WRITE_BUFFER) : a.target;
+        gl::bind_buffer(target, a.buffer);
+        glBufferSubData(target, a.offset, a.size, payload + sizeof(buffer_arguments));
+      } break;
+      case op::draw_arrays: {
+        const auto& a = arguments<draw_arguments>(payload);
+        if (a.instances) {
+          glDrawArraysInstanced(a.mode, a.first, a.count, a.instances);
+        } else {
+          glDrawArrays(a.mode, a.first, a.count);
+        }
+      } break;
+      case op::draw_elements: {
+        const auto& a = arguments<draw_arguments>(payload);
+        const auto indices = reinterpret_cast<const void*>(a.offset);
+        if (a.instances) {
+          glDrawElementsInstanced(a.mode, a.count, a.type, indices, a.instances);
+        } else {
+          glDrawElements(a.mode, a.count, a.type, indices);
+        }
+      } break;
+      }
+    }
+  }
+}
+
+void commands::clear() noexcept {
+  for (auto& chunk : chunks_) {
+    chunk.size = 0;
+  }
+  chunk_ = 0;
+  count_ = 0;
+}
+
+void* commands::push(op op, std::size_t size, std::size_t bytes, const void* data) {
+  const auto total = (sizeof(header) + size + bytes + alignment - 1) / alignment * alignment;
+
+  // Continue in the next block when the command does not fit and replace blocks that are too small.
+  if (chunks_.empty() || chunks_[chunk_].size + total > chunks_[chunk_].capacity) {
+    if (!chunks_.empty() && chunks_[chunk_].size) {
+      chunk_++;
+    }
+    if (chunk_ == chunks_.size()) {
+      chunks_.emplace_back();
+    }
+    auto& chunk = chunks_[chunk_];
+    if (chunk.capacity < total) {
+      chunk.capacity = std::max(block, total);
+      chunk.data = std::make_unique<std::byte[]>(chunk.capacity);
+    }
+  }
+  auto& chunk = chunks_[chunk_];
+  const auto command = chunk.data.get() + chunk.size;
+  *reinterpret_cast<header*>(command) = { op, static_cast<std::uint32_t>(total) };
+  const auto payload = command + sizeof(header);
+  if (bytes) {
+    std::memcpy(payload + size, data, bytes);
+  }
+  chunk.size += total;
+  count_++;
+  return payload;
+}
+
+}  // namespace gl
@@ -0,0 +1,88 @@
+#pragma once
+#include <GLES3/gl3.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace gl {
+
+// Command list that can be recorded on any thread and replayed on the thread that owns the context.
+//
+// Recording does not call OpenGL ES. Commands and their data are copied into arena blocks that are kept
+// when the list is cleared, so that a list recorded every frame stops allocating after the first frames.
+// Binds are replayed through the state of the replaying thread and skip redundant calls.
+class commands {
+public:
+  // Size of an arena block. Larger commands get a block of their own.
+  static constexpr std::size_t block = 64 * 1024;
+
+  commands() noexcept = default;
+
+  commands(commands&& other) noexcept = default;
+  commands& operator=(commands&& other) noexcept = default;
+
+  void use_program(GLuint program);
+  void bind_vertex_array(GLuint array);
+  void bind_buffer(GLenum target, GLuint buffer);
+  void bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+  void bind_texture(GLuint unit, GLenum target, GLuint texture);
+  void bind_framebuffer(GLenum target, GLuint framebuffer);
+  void enable(GLenum capability, bool enable);
+  void viewport(GLint x, GLint y, GLsizei cx, GLsizei cy);
+
+  // Integer attribute of the bound vertex array sourced from the buffer. Enables the attribute array.
+  void vertex_attrib_ipointer(GLuint index, GLint size, GLenum type, GLsizei stride, GLuint buffer, GLintptr offset,
+    GLuint divisor = 0);
+
+  // Uniform writes for the program used at replay time. The values are copied.
+  void uniform(GLint location, GLint value);
+  void uniform(GLint location, GLfloat value);
+  void uniform2(GLint location, const GLfloat* values, GLsizei count = 1);
+  void uniform3(GLint location, const GLfloat* values, GLsizei count = 1);
+  void uniform4(GLint location, const GLfloat* values, GLsizei count = 1);
+  void uniform_matrix4(GLint location, const GLfloat* values, GLsizei count = 1);
+
+  // Buffer update through the given target. The data is copied. Element array buffers are updated through
+  // GL_COPY_WRITE_BUFFER, so that the element buffer of the bound vertex array is left alone.
+  void buffer_sub_data(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+  void draw_arrays(GLenum mode, GLint first, GLsizei count);
+  void draw_arrays_instanced(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+  void draw_elements(GLenum mode, GLsizei count, GLenum type, GLintptr offset);
+  void draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, GLintptr offset, GLsizei instances);
+
+  // Executes the recorded commands in order. Must be called with a current context.
+  void replay() const;
+
+  // Removes all commands and keeps the arena blocks.
+  void clear() noexcept;
+
+  bool empty() const noexcept {
+    return !count_;
+  }
+
+  // Returns the number of recorded commands.
+  std::size_t size() const noexcept {
+    return count_;
+  }
+
+private:
+  enum class op : std::uint32_t;
+  struct header;
+
+  struct chunk {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t capacity = 0;
+    std::size_t size = 0;
+  };
+
+  // Reserves space for a command with the given payload and returns the payload.
+  void* push(op op, std::size_t size, std::size_t bytes = 0, const void* data = nullptr);
+
+  std::vector<chunk> chunks_;
+  std::size_t chunk_ = 0;
+  std::size_t count_ = 0;
+};
+
+}  // namespace gl
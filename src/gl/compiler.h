@@ -0,0 +1,78 @@
+#pragma once
+#include <gl/cache.h>
+#include <gl/extensions.h>
+#include <gl/program.h>
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace gl {
+
+// Compiles many programs concurrently.
+//
+// Programs are submitted without querying their status, so the driver can overlap compilation and linking.
+// With KHR_parallel_shader_compile the driver uses its own threads and ready() polls the completion status
+// without blocking. Errors are reported when a program is awaited.
+class compiler {
+public:
+  // Must be called with a current context.
+  compiler() {
+    if (extension("GL_KHR_parallel_shader_compile")) {
+      if (const auto max_threads = proc<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>("glMaxShaderCompilerThreadsKHR")) {
+        max_threads(0xFFFFFFFF);
+      }
+    }
+  }
+
+  // Must be called with a current context. The cache must outlive the compiler.
+  explicit compiler(const cache& cache) : compiler() {
+    cache_ = &cache;
+  }
+
+  // Submits a program and returns its index.
+  std::size_t submit(std::string_view vert, std::string_view frag) {
+    if (cache_) {
+      programs_.emplace_back(vert, frag, *cache_, deferred);
+    } else {
+      programs_.emplace_back(vert, frag, deferred);
+    }
+    return programs_.size() - 1;
+  }
+
+  // Checks if all submitted programs are ready without blocking.
+  bool ready() const noexcept {
+    return std::all_of(programs_.begin(), programs_.end(), [](const program& program) { return program.ready(); });
+  }
+
+  // Checks if the program is ready without blocking.
+  bool ready(std::size_t index) const noexcept {
+    return programs_[index].ready();
+  }
+
+  // Waits for the program and returns it. Throws on errors.
+  // The compiler owns the program until wait() returns all programs, so the reference is valid until then.
+  program& wait(std::size_t index) {
+    auto& program = programs_.at(index);
+    program.wait();
+    return program;
+  }
+
+  // Waits for all submitted programs and returns them in submission order. Throws on the first error.
+  std::vector<program> wait() {
+    for (auto& program : programs_) {
+      program.wait();
+    }
+    return std::exchange(programs_, {});
+  }
+
+  std::size_t size() const noexcept {
+    return programs_.size();
+  }
+
+private:
+  const cache* cache_ = nullptr;
+  std::vector<program> programs_;
+};
+
+}  // namespace gl
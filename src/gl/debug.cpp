@@ -0,0 +1,114 @@
+#include <gl/debug.h>
+#include <gl/extensions.h>
+#include <GLES2/gl2ext.h>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gl {
+namespace {
+
+PFNGLDEBUGMESSAGECALLBACKKHRPROC glDebugMessageCallback = nullptr;
+PFNGLDEBUGMESSAGECONTROLKHRPROC glDebugMessageControl = nullptr;
+PFNGLPUSHDEBUGGROUPKHRPROC glPushDebugGroup = nullptr;
+PFNGLPOPDEBUGGROUPKHRPROC glPopDebugGroup = nullptr;
+
+std::mutex mutex;
+debug_handler handler;
+bool enabled = false;
+
+// Labels of the debug groups pushed by markers, in the order the driver reported them.
+std::vector<std::string> groups;
+
+void GL_APIENTRY callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* text, const void* user) {
+  const auto size = length < 0 ? std::strlen(text) : static_cast<std::size_t>(length);
+  if (type == GL_DEBUG_TYPE_PUSH_GROUP_KHR) {
+    std::lock_guard<std::mutex> lock(mutex);
+    groups.emplace_back(text, size);
+    return;
+  }
+  if (type == GL_DEBUG_TYPE_POP_GROUP_KHR) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!groups.empty()) {
+      groups.pop_back();
+    }
+    return;
+  }
+  if (type != GL_DEBUG_TYPE_ERROR_KHR && severity != GL_DEBUG_SEVERITY_HIGH_KHR) {
+    return;
+  }
+  debug_message message;
+  message.source = source;
+  message.type = type;
+  message.id = id;
+  message.severity = severity;
+  message.text.assign(text, size);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!groups.empty()) {
+    message.location = groups.back();
+  }
+  if (handler) {
+    handler(message);
+  }
+}
+
+}  // namespace
+
+bool debug(debug_handler value, bool synchronous) {
+  if (!extension("GL_KHR_debug")) {
+    return false;
+  }
+  glDebugMessageCallback = proc<PFNGLDEBUGMESSAGECALLBACKKHRPROC>("glDebugMessageCallbackKHR");
+  glDebugMessageControl = proc<PFNGLDEBUGMESSAGECONTROLKHRPROC>("glDebugMessageControlKHR");
+  glPushDebugGroup = proc<PFNGLPUSHDEBUGGROUPKHRPROC>("glPushDebugGroupKHR");
+  glPopDebugGroup = proc<PFNGLPOPDEBUGGROUPKHRPROC>("glPopDebugGroupKHR");
+  if (!glDebugMessageCallback || !glDebugMessageControl || !glPushDebugGroup || !glPopDebugGroup) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    handler = std::move(value);
+    groups.clear();
+  }
+
+  // Markers generate push and pop notifications, which track the location of the messages.
+  glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PUSH_GROUP_KHR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+  glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_POP_GROUP_KHR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+  glDebugMessageCallback(callback, nullptr);
+  glEnable(GL_DEBUG_OUTPUT_KHR);
+  if (synchronous) {
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+  } else {
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+  }
+  enabled = true;
+  return true;
+}
+
+void debug_reset() noexcept {
+  if (!enabled) {
+    return;
+  }
+  glDisable(GL_DEBUG_OUTPUT_KHR);
+  glDebugMessageCallback(nullptr, nullptr);
+  enabled = false;
+  std::lock_guard<std::mutex> lock(mutex);
+  handler = {};
+  groups.clear();
+}
+
+marker::marker(const char* label) noexcept {
+  if (enabled) {
+    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION_KHR, 0, -1, label);
+    group_ = true;
+  }
+}
+
+marker::~marker() {
+  if (group_) {
+    glPopDebugGroup();
+  }
+}
+
+}  // namespace gl
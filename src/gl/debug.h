@@ -0,0 +1,50 @@
+#pragma once
+#include <GLES3/gl3.h>
+#include <functional>
+#include <string>
+
+namespace gl {
+
+struct debug_message {
+  GLenum source = 0;
+  GLenum type = 0;
+  GLuint id = 0;
+  GLenum severity = 0;
+  std::string text;
+
+  // Label of the innermost marker that was active when the command that caused the message was issued.
+  // Empty outside of markers.
+  std::string location;
+};
+
+using debug_handler = std::function<void(const debug_message& message)>;
+
+// Installs a KHR_debug message callback that reports errors and high severity messages.
+// Asynchronous reporting lets the driver call the handler from any thread. The location is
+// tracked from the push and pop group messages of the markers, which the driver reports in
+// command order, so it is valid in both modes. Returns false when KHR_debug is not available.
+bool debug(debug_handler handler, bool synchronous = false);
+
+// Removes the message callback.
+void debug_reset() noexcept;
+
+// Names a region of GL calls. Pushes a debug group when a debug callback is installed,
+// which provides the location reported with debug messages.
+class marker {
+public:
+  explicit marker(const char* label) noexcept;
+  marker(marker&& other) = delete;
+  marker& operator=(marker&& other) = delete;
+  ~marker();
+
+private:
+  bool group_ = false;
+};
+
+}  // namespace gl
+
+#define GL_MARKER_STRING(value) #value
+#define GL_MARKER_LINE(line) GL_MARKER_STRING(line)
+
+// Creates a marker labeled with the name and source location of the enclosing scope.
+#define GL_MARKER(name) const gl::marker gl_marker_(name " (" __FILE__ ":" GL_MARKER_LINE(__LINE__) ")")
@@ -1,5 +1,7 @@
 #include <gl/error.h>
 #include <GLES3/gl3.h>
+#include <algorithm>
+#include <atomic>
 #include <string>
 
 namespace gl {
@@ -14,12 +16,12 @@ public:
 
   std::string message(int code) const override {
     switch (static_cast<GLenum>(code)) {
-    case GL_NO_ERROR: "Success";
-    case GL_INVALID_ENUM: "Invalid enumerated argument";
-    case GL_INVALID_VALUE: "Invalid numeric argument";
-    case GL_INVALID_OPERATION: "Invalid operation";
-    case GL_INVALID_FRAMEBUFFER_OPERATION: "Invalid framebuffer operation";
-    case GL_OUT_OF_MEMORY: "Out of memory";
+    case GL_NO_ERROR: return "Success";
+    case GL_INVALID_ENUM: return "Invalid enumerated argument";
+    case GL_INVALID_VALUE: return "Invalid numeric argument";
+    case GL_INVALID_OPERATION: return "Invalid operation";
+    case GL_INVALID_FRAMEBUFFER_OPERATION: return "Invalid framebuffer operation";
+    case GL_OUT_OF_MEMORY: return "Out of memory";
     }
     return "Unknown error code: " + std::to_string(code);
   }
@@ -38,4 +40,19 @@ std::error_code error(int ev) {
   return { ev, error_category() };
 }
 
+namespace {
+
+constexpr auto policy_limit = static_cast<error_policy>(GL_ERROR_POLICY);
+std::atomic<error_policy> policy_value = policy_limit;
+
+}  // namespace
+
+error_policy policy() noexcept {
+  return policy_value.load(std::memory_order_relaxed);
+}
+
+void policy(error_policy policy) noexcept {
+  policy_value.store(std::min(policy, policy_limit), std::memory_order_relaxed);
+}
+
 }  // namespace gl
@@ -2,13 +2,55 @@
 #include <stdexcept>
 #include <system_error>
 
+// Compile-time upper bound of the error checking policy: 0 disables all checks,
+// 1 allows checks once per frame and 2 allows checks after every call.
+#ifndef GL_ERROR_POLICY
+#ifdef NDEBUG
+#define GL_ERROR_POLICY 1
+#else
+#define GL_ERROR_POLICY 2
+#endif
+#endif
+
 namespace gl {
 
+enum class error_policy {
+  none,   // Never call glGetError.
+  frame,  // Call glGetError once per frame.
+  call,   // Call glGetError after every wrapped call.
+};
+
 const std::error_category& error_category();
 
 std::error_code error();
 std::error_code error(int ev);
 
+// Returns the current error checking policy.
+error_policy policy() noexcept;
+
+// Sets the error checking policy. The policy is limited by GL_ERROR_POLICY.
+void policy(error_policy policy) noexcept;
+
+// Returns the current error when the policy checks every call. Used by the wrappers after each call.
+inline std::error_code check() {
+#if GL_ERROR_POLICY >= 2
+  if (policy() == error_policy::call) {
+    return error();
+  }
+#endif
+  return {};
+}
+
+// Returns the current error when the policy checks at least once per frame. Used at the end of a frame.
+inline std::error_code check_frame() {
+#if GL_ERROR_POLICY >= 1
+  if (policy() != error_policy::none) {
+    return error();
+  }
+#endif
+  return {};
+}
+
 class runtime_error : public std::runtime_error {
 public:
   using std::runtime_error::runtime_error;
@@ -16,7 +58,7 @@ public:
 
 class system_error : public std::system_error {
 public:
-  std::system_error::system_error;
+  using std::system_error::system_error;
 };
 
 }  // namespace gl
@@ -0,0 +1,27 @@
+#pragma once
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include <cstring>
+
+namespace gl {
+
+// Checks if the current context supports the given extension.
+inline bool extension(const char* name) noexcept {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++) {
+    const auto value = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+    if (value && std::strcmp(value, name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Loads an extension entry point. Returns nullptr when the implementation does not provide it.
+template <typename T>
+inline T proc(const char* name) noexcept {
+  return reinterpret_cast<T>(eglGetProcAddress(name));
+}
+
+}  // namespace gl
@@ -0,0 +1,67 @@
+#pragma once
+#include <gl/error.h>
+#include <gl/resource.h>
+
+namespace gl {
+
+class fence {
+public:
+  fence() noexcept = default;
+
+  explicit fence(GLenum condition) {
+    handle_.reset(glFenceSync(condition, 0));
+    if (const auto ec = check()) {
+      throw system_error(ec, "Could not create fence sync object");
+    }
+  }
+
+  // Checks if the fence was signaled without blocking.
+  bool signaled() const noexcept {
+    if (!handle_) {
+      return true;
+    }
+    GLint status = GL_UNSIGNALED;
+    glGetSynciv(handle_, GL_SYNC_STATUS, 1, nullptr, &status);
+    return status == GL_SIGNALED;
+  }
+
+  // Blocks the calling thread until the fence is signaled or the timeout in nanoseconds expires.
+  bool wait(GLuint64 timeout = GL_TIMEOUT_IGNORED) const {
+    if (!handle_) {
+      return true;
+    }
+    switch (glClientWaitSync(handle_, GL_SYNC_FLUSH_COMMANDS_BIT, timeout)) {
+    case GL_ALREADY_SIGNALED:
+    case GL_CONDITION_SATISFIED:
+      return true;
+    case GL_TIMEOUT_EXPIRED:
+      return false;
+    }
+    throw system_error(error(), "Could not wait for fence sync object");
+  }
+
+  // Makes the server wait for the fence before executing further commands.
+  // Useful when the fence was created on another context.
+  void wait_server() const noexcept {
+    if (handle_) {
+      glWaitSync(handle_, 0, GL_TIMEOUT_IGNORED);
+    }
+  }
+
+  explicit operator bool() const noexcept {
+    return static_cast<GLsync>(handle_) != nullptr;
+  }
+
+  operator GLsync() const noexcept {
+    return handle_;
+  }
+
+  static void release(GLsync handle) noexcept {
+    glDeleteSync(handle);
+  }
+
+private:
+  resource<GLsync, fence> handle_;
+};
+
+}  // namespace gl
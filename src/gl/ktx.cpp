@@ -0,0 +1,340 @@
+#include <gl/ktx.h>
+#include <gl/error.h>
+#include <gl/state.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gl {
+namespace {
+
+constexpr std::uint8_t ktx1_identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+constexpr std::uint8_t ktx2_identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+template <typename T>
+T read(const std::uint8_t* data, std::size_t offset) noexcept {
+  T value = 0;
+  std::memcpy(&value, data + offset, sizeof(value));
+  return value;
+}
+
+// Returns the size of a 4x4 block in bytes or 0 for unsupported formats.
+std::size_t block_size(GLenum format) noexcept {
+  switch (format) {
+  case GL_COMPRESSED_RGB8_ETC2:
+  case GL_COMPRESSED_SRGB8_ETC2:
+  case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+  case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+  case GL_COMPRESSED_R11_EAC:
+  case GL_COMPRESSED_SIGNED_R11_EAC:
+    return 8;
+  case GL_COMPRESSED_RGBA8_ETC2_EAC:
+  case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+  case GL_COMPRESSED_RG11_EAC:
+  case GL_COMPRESSED_SIGNED_RG11_EAC:
+    return 16;
+  }
+  return 0;
+}
+
+// Maps Vulkan formats used by KTX 2.0 to OpenGL ES internal formats.
+GLenum vulkan_format(std::uint32_t format) noexcept {
+  switch (format) {
+  case 37: return GL_RGBA8;
+  case 43: return GL_SRGB8_ALPHA8;
+  case 147: return GL_COMPRESSED_RGB8_ETC2;
+  case 148: return GL_COMPRESSED_SRGB8_ETC2;
+  case 149: return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+  case 150: return GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+  case 151: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+  case 152: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+  case 153: return GL_COMPRESSED_R11_EAC;
+  case 154: return GL_COMPRESSED_SIGNED_R11_EAC;
+  case 155: return GL_COMPRESSED_RG11_EAC;
+  case 156: return GL_COMPRESSED_SIGNED_RG11_EAC;
+  }
+  return GL_NONE;
+}
+
+}  // namespace
+
+ktx::ktx(const std::filesystem::path& path) {
+#ifdef WIN32
+  const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw runtime_error("Could not open texture: " + path.string());
+  }
+  LARGE_INTEGER size = {};
+  GetFileSizeEx(file, &size);
+  handle_ = size.QuadPart ? CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+  CloseHandle(file);
+  if (handle_) {
+    data_ = static_cast<const std::uint8_t*>(MapViewOfFile(handle_, FILE_MAP_READ, 0, 0, 0));
+  }
+  size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+  const auto file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file < 0) {
+    throw runtime_error("Could not open texture: " + path.string());
+  }
+  struct stat info = {};
+  if (::fstat(file, &info) == 0 && info.st_size > 0) {
+    size_ = static_cast<std::size_t>(info.st_size);
+    const auto data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+    if (data != MAP_FAILED) {
+      data_ = static_cast<const std::uint8_t*>(data);
+    }
+  }
+  ::close(file);
+#endif
+  if (!data_) {
+    unmap();
+    throw runtime_error("Could not map texture: " + path.string());
+  }
+  try {
+    if (size_ >= sizeof(ktx1_identifier) && std::memcmp(data_, ktx1_identifier, sizeof(ktx1_identifier)) == 0) {
+      parse_ktx1();
+    } else if (size_ >= sizeof(ktx2_identifier) && std::memcmp(data_, ktx2_identifier, sizeof(ktx2_identifier)) == 0) {
+      parse_ktx2();
+    } else {
+      throw runtime_error("Invalid texture container.");
+    }
+    validate();
+  }
+  catch (const std::exception& e) {
+    unmap();
+    throw runtime_error("Could not load texture: " + path.string() + ": " + e.what());
+  }
+}
+
+ktx::ktx(ktx&& other) noexcept :
+  data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+  handle_(std::exchange(other.handle_, nullptr)), target_(other.target_), format_(other.format_),
+  compressed_(other.compressed_), cx_(other.cx_), cy_(other.cy_), layers_(other.layers_), faces_(other.faces_),
+  array_(other.array_), levels_(std::move(other.levels_)) {}
+
+ktx& ktx::operator=(ktx&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    handle_ = std::exchange(other.handle_, nullptr);
+    target_ = other.target_;
+    format_ = other.format_;
+    compressed_ = other.compressed_;
+    cx_ = other.cx_;
+    cy_ = other.cy_;
+    layers_ = other.layers_;
+    faces_ = other.faces_;
+    array_ = other.array_;
+    levels_ = std::move(other.levels_);
+  }
+  return *this;
+}
+
+ktx::~ktx() {
+  unmap();
+}
+
+textures ktx::create() const {
+  // Client memory is only used when no pixel unpack buffer is bound.
+  bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  textures texture(1);
+  bind_texture(0, target_, texture[0]);
+  const auto levels = static_cast<GLsizei>(levels_.size());
+  if (target_ == GL_TEXTURE_2D_ARRAY) {
+    glTexStorage3D(target_, levels, format_, cx_, cy_, layers_);
+  } else {
+    glTexStorage2D(target_, levels, format_, cx_, cy_);
+  }
+  for (GLsizei i = 0; i < levels; i++) {
+    const auto cx = std::max(cx_ >> i, 1);
+    const auto cy = std::max(cy_ >> i, 1);
+    const auto& level = levels_[static_cast<std::size_t>(i)];
+    if (target_ == GL_TEXTURE_2D_ARRAY) {
+      if (compressed_) {
+        glCompressedTexSubImage3D(target_, i, 0, 0, 0, cx, cy, layers_, format_,
+          static_cast<GLsizei>(level.size), level.data);
+      } else {
+        glTexSubImage3D(target_, i, 0, 0, 0, cx, cy, layers_, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+      }
+      continue;
+    }
+    const auto face_size = level.size / static_cast<std::size_t>(faces_);
+    for (GLsizei face = 0; face < faces_; face++) {
+      const auto target = target_ == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : target_;
+      const auto data = level.data + face_size * static_cast<std::size_t>(face);
+      if (compressed_) {
+        glCompressedTexSubImage2D(target, i, 0, 0, cx, cy, format_, static_cast<GLsizei>(face_size), data);
+      } else {
+        glTexSubImage2D(target, i, 0, 0, cx, cy, GL_RGBA, GL_UNSIGNED_BYTE, data);
+      }
+    }
+  }
+  glTexParameteri(target_, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(target_, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  if (const auto ec = check()) {
+    throw system_error(ec, "Could not upload texture");
+  }
+  return texture;
+}
+
+void ktx::parse_ktx1() {
+  // Identifier followed by 13 32-bit header fields.
+  constexpr std::size_t header = 12 + 13 * 4;
+  if (size_ < header) {
+    throw runtime_error("Truncated header.");
+  }
+  if (read<std::uint32_t>(data_, 12) != 0x04030201) {
+    throw runtime_error("Unsupported endianness.");
+  }
+  const auto type = read<std::uint32_t>(data_, 16);
+  const auto format = read<std::uint32_t>(data_, 24);
+  format_ = read<std::uint32_t>(data_, 28);
+  cx_ = static_cast<GLsizei>(read<std::uint32_t>(data_, 36));
+  cy_ = static_cast<GLsizei>(read<std::uint32_t>(data_, 40));
+  const auto depth = read<std::uint32_t>(data_, 44);
+  const auto layers = read<std::uint32_t>(data_, 48);
+  faces_ = static_cast<GLsizei>(read<std::uint32_t>(data_, 52));
+  const auto levels = std::max<std::uint32_t>(read<std::uint32_t>(data_, 56), 1);
+  const auto metadata = read<std::uint32_t>(data_, 60);
+  if (depth > 1) {
+    throw runtime_error("3D textures are not supported.");
+  }
+  if (type == 0 && format == 0) {
+    compressed_ = true;
+  } else if (type != GL_UNSIGNED_BYTE || format != GL_RGBA) {
+    throw runtime_error("Unsupported pixel format.");
+  }
+  array_ = layers > 0;
+  layers_ = static_cast<GLsizei>(std::max<std::uint32_t>(layers, 1));
+
+  // Each level starts with its size. The size of non-array cube maps is the size of one face.
+  auto offset = header + static_cast<std::size_t>(metadata);
+  for (std::uint32_t i = 0; i < levels && i < 32; i++) {
+    if (offset + 4 > size_) {
+      throw runtime_error("Truncated mip level.");
+    }
+    auto size = static_cast<std::size_t>(read<std::uint32_t>(data_, offset));
+    if (!array_ && faces_ == 6) {
+      size = (size + 3) / 4 * 4 * 6;
+    }
+    offset += 4;
+    if (offset + size > size_) {
+      throw runtime_error("Truncated mip level.");
+    }
+    levels_.push_back({ data_ + offset, size });
+    offset += (size + 3) / 4 * 4;
+  }
+}
+
+void ktx::parse_ktx2() {
+  // Identifier followed by 9 32-bit header fields, the index and the level index.
+  constexpr std::size_t header = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+  if (size_ < header) {
+    throw runtime_error("Truncated header.");
+  }
+  format_ = vulkan_format(read<std::uint32_t>(data_, 12));
+  cx_ = static_cast<GLsizei>(read<std::uint32_t>(data_, 20));
+  cy_ = static_cast<GLsizei>(read<std::uint32_t>(data_, 24));
+  const auto depth = read<std::uint32_t>(data_, 28);
+  const auto layers = read<std::uint32_t>(data_, 32);
+  faces_ = static_cast<GLsizei>(read<std::uint32_t>(data_, 36));
+  const auto levels = std::max<std::uint32_t>(read<std::uint32_t>(data_, 40), 1);
+  if (read<std::uint32_t>(data_, 44) != 0) {
+    throw runtime_error("Supercompression is not supported.");
+  }
+  if (depth > 1) {
+    throw runtime_error("3D textures are not supported.");
+  }
+  if (format_ == GL_NONE) {
+    throw runtime_error("Unsupported pixel format.");
+  }
+  compressed_ = format_ != GL_RGBA8 && format_ != GL_SRGB8_ALPHA8;
+  array_ = layers > 0;
+  layers_ = static_cast<GLsizei>(std::max<std::uint32_t>(layers, 1));
+  if (levels > 32 || header + levels * 24 > size_) {
+    throw runtime_error("Truncated level index.");
+  }
+  for (std::uint32_t i = 0; i < levels; i++) {
+    const auto offset = read<std::uint64_t>(data_, header + i * 24);
+    const auto size = read<std::uint64_t>(data_, header + i * 24 + 8);
+    if (offset > size_ || size > size_ - offset) {
+      throw runtime_error("Truncated mip level.");
+    }
+    levels_.push_back({ data_ + offset, static_cast<std::size_t>(size) });
+  }
+}
+
+void ktx::validate() {
+  if (cx_ <= 0 || cy_ <= 0) {
+    throw runtime_error("Invalid texture size.");
+  }
+  if (faces_ != 1 && faces_ != 6) {
+    throw runtime_error("Invalid number of faces.");
+  }
+  if (faces_ == 6 && array_) {
+    throw runtime_error("Cube map arrays are not supported.");
+  }
+  if (compressed_ ? !block_size(format_) : format_ != GL_RGBA8 && format_ != GL_SRGB8_ALPHA8) {
+    throw runtime_error("Unsupported internal format.");
+  }
+  target_ = faces_ == 6 ? GL_TEXTURE_CUBE_MAP : array_ ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+  if (levels_.size() > 1) {
+    auto levels = 1;
+    while ((std::max(cx_, cy_) >> levels) > 0) {
+      levels++;
+    }
+    if (levels_.size() > static_cast<std::size_t>(levels)) {
+      throw runtime_error("Too many mip levels.");
+    }
+  }
+  for (std::size_t i = 0; i < levels_.size(); i++) {
+    if (levels_[i].size < level_size(static_cast<GLsizei>(i))) {
+      throw runtime_error("Truncated mip level.");
+    }
+  }
+}
+
+std::size_t ktx::level_size(GLsizei level) const noexcept {
+  const auto cx = static_cast<std::size_t>(std::max(cx_ >> level, 1));
+  const auto cy = static_cast<std::size_t>(std::max(cy_ >> level, 1));
+  const auto images = static_cast<std::size_t>(layers_) * static_cast<std::size_t>(faces_);
+  if (compressed_) {
+    return (cx + 3) / 4 * ((cy + 3) / 4) * block_size(format_) * images;
+  }
+  return cx * cy * 4 * images;
+}
+
+void ktx::unmap() noexcept {
+#ifdef WIN32
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (handle_) {
+    CloseHandle(handle_);
+  }
+#else
+  if (data_) {
+    ::munmap(const_cast<std::uint8_t*>(data_), size_);
+  }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+  handle_ = nullptr;
+  levels_.clear();
+}
+
+}  // namespace gl
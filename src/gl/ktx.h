@@ -0,0 +1,92 @@
+#pragma once
+#include <gl/textures.h>
+#include <GLES3/gl3.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace gl {
+
+// KTX 1.1 and KTX 2.0 texture container.
+//
+// The file is memory mapped and the mip levels are passed to the driver straight from the mapping without
+// intermediate copies. Supports 2D textures, texture arrays and cube maps with ETC2/EAC compressed formats
+// as well as uncompressed RGBA8 data. KTX 2.0 files must not use supercompression.
+class ktx {
+public:
+  ktx() noexcept = default;
+
+  // Maps and validates the file. Throws on errors.
+  explicit ktx(const std::filesystem::path& path);
+
+  ktx(ktx&& other) noexcept;
+  ktx& operator=(ktx&& other) noexcept;
+
+  ~ktx();
+
+  // Creates a texture with immutable storage and uploads all mip levels, layers and faces.
+  textures create() const;
+
+  // Returns GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY or GL_TEXTURE_CUBE_MAP.
+  GLenum target() const noexcept {
+    return target_;
+  }
+
+  GLenum format() const noexcept {
+    return format_;
+  }
+
+  bool compressed() const noexcept {
+    return compressed_;
+  }
+
+  GLsizei cx() const noexcept {
+    return cx_;
+  }
+
+  GLsizei cy() const noexcept {
+    return cy_;
+  }
+
+  GLsizei layers() const noexcept {
+    return layers_;
+  }
+
+  GLsizei faces() const noexcept {
+    return faces_;
+  }
+
+  GLsizei levels() const noexcept {
+    return static_cast<GLsizei>(levels_.size());
+  }
+
+private:
+  // Image data of a mip level with all layers or faces.
+  struct level {
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+  };
+
+  void parse_ktx1();
+  void parse_ktx2();
+  void validate();
+  std::size_t level_size(GLsizei level) const noexcept;
+  void unmap() noexcept;
+
+  const std::uint8_t* data_ = nullptr;
+  std::size_t size_ = 0;
+  void* handle_ = nullptr;
+
+  GLenum target_ = GL_TEXTURE_2D;
+  GLenum format_ = GL_NONE;
+  bool compressed_ = false;
+  GLsizei cx_ = 0;
+  GLsizei cy_ = 0;
+  GLsizei layers_ = 1;
+  GLsizei faces_ = 1;
+  bool array_ = false;
+  std::vector<level> levels_;
+};
+
+}  // namespace gl
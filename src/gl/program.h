@@ -1,10 +1,19 @@
 #pragma once
+#include <gl/cache.h>
 #include <gl/error.h>
+#include <gl/extensions.h>
 #include <gl/resource.h>
 #include <gl/shader.h>
+#include <gl/state.h>
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace gl {
 
@@ -13,50 +22,184 @@ public:
   program() noexcept = default;
 
   explicit program(const shader& vert, const shader& frag) {
+    create();
+    link(vert, frag);
+    validate(vert, frag);
+    resolve();
+  }
+
+  explicit program(std::string_view vert, std::string_view frag) :
+    program(gl::shader(vert, GL_VERTEX_SHADER), gl::shader(frag, GL_FRAGMENT_SHADER)) {}
+
+  // Loads the program binary from the cache or compiles the program and stores its binary in the cache.
+  explicit program(std::string_view vert, std::string_view frag, const cache& cache) :
+    program(vert, frag, cache, deferred) {
+    wait();
+  }
+
+  // Submits the program without waiting for compilation and linking. Errors are reported by wait() or when the
+  // program is first used.
+  explicit program(std::string_view vert, std::string_view frag, deferred_t) :
+    program(vert, frag, cache(), deferred) {}
+
+  // Submits the program or loads it from the cache without waiting. Errors are reported by wait() or when the
+  // program is first used.
+  explicit program(std::string_view vert, std::string_view frag, const cache& cache, deferred_t) {
+    create();
+    std::uint64_t key = 0;
+    if (cache) {
+      key = cache.key(vert, frag);
+      if (cache.load(handle_, key)) {
+        resolve();
+        return;
+      }
+      glProgramParameteri(handle_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      if (const auto ec = check()) {
+        throw system_error(ec, "Could not set program binary retrievable hint");
+      }
+    }
+    pending_ = std::make_unique<pending>();
+    pending_->vert = gl::shader(vert, GL_VERTEX_SHADER, deferred);
+    pending_->frag = gl::shader(frag, GL_FRAGMENT_SHADER, deferred);
+    pending_->storage = cache ? &cache : nullptr;
+    pending_->key = key;
+    pending_->parallel = extension("GL_KHR_parallel_shader_compile");
+    link(pending_->vert, pending_->frag);
+  }
+
+  // Checks if compilation and linking finished without blocking.
+  // Always returns true when the implementation does not support KHR_parallel_shader_compile.
+  bool ready() const noexcept {
+    if (!pending_ || !pending_->parallel) {
+      return true;
+    }
+    GLint status = GL_FALSE;
+    glGetProgramiv(handle_, GL_COMPLETION_STATUS_KHR, &status);
+    return status == GL_TRUE;
+  }
+
+  // Waits for compilation and linking to finish and throws on errors.
+  // Called by the conversion to GLuint, uniform() and block(), so a deferred program is never used unlinked.
+  void wait() const {
+    if (!pending_) {
+      return;
+    }
+    const auto pending = std::move(pending_);
+    validate(pending->vert, pending->frag);
+    resolve();
+    if (pending->storage) {
+      pending->storage->store(handle_, pending->key);
+    }
+  }
+
+  GLint attribute(const char* name) const {
+    wait();
+    return glGetAttribLocation(handle_, name);
+  }
+
+  // Returns the uniform location or -1 when the uniform is not active. The locations of all active uniforms
+  // are resolved once after linking. Array elements other than the first are looked up in the driver.
+  GLint uniform(std::string_view name) const {
+    wait();
+    const auto it = std::lower_bound(locations_.begin(), locations_.end(), name, [](const auto& location, auto name) {
+      return location.first < name;
+    });
+    if (it != locations_.end() && it->first == name) {
+      return it->second;
+    }
+    if (name.find('[') != std::string_view::npos) {
+      return glGetUniformLocation(handle_, std::string(name).data());
+    }
+    return -1;
+  }
+
+  // Assigns a uniform block binding point. Must be called once after the program was linked.
+  // Throws when the block size differs from the given size. Returns false when the block is not active.
+  bool block(const char* name, GLuint binding, GLsizeiptr size = 0) const {
+    wait();
+    const auto index = glGetUniformBlockIndex(handle_, name);
+    if (index == GL_INVALID_INDEX) {
+      return false;
+    }
+    if (size) {
+      GLint data_size = 0;
+      glGetActiveUniformBlockiv(handle_, index, GL_UNIFORM_BLOCK_DATA_SIZE, &data_size);
+      if (data_size != size) {
+        throw runtime_error("Uniform block " + std::string(name) + " does not match its std140 layout.");
+      }
+    }
+    glUniformBlockBinding(handle_, index, binding);
+    if (const auto ec = check()) {
+      throw system_error(ec, "Could not set uniform block binding");
+    }
+    return true;
+  }
+
+  // Waits for a deferred program. Throws on compilation and link errors.
+  operator GLuint() const {
+    wait();
+    return handle_;
+  }
+
+  static void release(GLuint handle) noexcept {
+    state::forget_program(handle);
+    glDeleteProgram(handle);
+  }
+
+private:
+  void create() {
     handle_.reset(glCreateProgram());
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not create program");
     }
+  }
 
+  void link(const shader& vert, const shader& frag) {
     glAttachShader(handle_, vert);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not attach vertex shader");
     }
 
     glAttachShader(handle_, frag);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not attach fragment shader");
     }
 
     glLinkProgram(handle_);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not link program");
     }
 
     glDetachShader(handle_, frag);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not detach fragment shader");
     }
 
     glDetachShader(handle_, vert);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not detach vertex shader");
     }
+  }
 
+  void validate(const shader& vert, const shader& frag) const {
     GLint success = GL_FALSE;
     glGetProgramiv(handle_, GL_LINK_STATUS, &success);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not get program link status");
     }
 
     if (!success) {
+      // Report compilation errors of deferred shaders first.
+      vert.wait();
+      frag.wait();
+
       std::string info;
       GLsizei size = 0;
       glGetProgramiv(handle_, GL_INFO_LOG_LENGTH, &size);
-      if (!error()) {
+      if (!check()) {
         info.resize(size);
         glGetProgramInfoLog(handle_, size, &size, &info[0]);
-        if (!error()) {
+        if (!check()) {
           info.resize(size);
         } else {
           info.clear();
@@ -66,27 +209,44 @@ public:
     }
   }
 
-  explicit program(std::string_view vert, std::string_view frag) :
-    program(gl::shader(vert, GL_VERTEX_SHADER), gl::shader(frag, GL_FRAGMENT_SHADER)) {}
-
-  GLint attribute(const char* name) const noexcept {
-    return glGetAttribLocation(handle_, name);
-  }
-
-  GLint uniform(const char* name) const noexcept {
-    return glGetUniformLocation(handle_, name);
-  }
-
-  operator GLuint() const noexcept {
-    return handle_;
+  // Stores the locations of the active uniforms sorted by name. Arrays are stored with and without "[0]".
+  void resolve() const {
+    locations_.clear();
+    GLint count = 0;
+    GLint length = 0;
+    glGetProgramiv(handle_, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(handle_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &length);
+    std::string name;
+    for (GLint i = 0; i < count; i++) {
+      name.resize(static_cast<std::size_t>(std::max(length, 1)));
+      GLsizei size = 0;
+      GLint elements = 0;
+      GLenum type = GL_NONE;
+      glGetActiveUniform(handle_, static_cast<GLuint>(i), length, &size, &elements, &type, name.data());
+      name.resize(static_cast<std::size_t>(size));
+      const auto location = glGetUniformLocation(handle_, name.data());
+      locations_.emplace_back(name, location);
+      if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+        locations_.emplace_back(name.substr(0, name.size() - 3), location);
+      }
+    }
+    if (const auto ec = check()) {
+      throw system_error(ec, "Could not get active uniforms");
+    }
+    std::sort(locations_.begin(), locations_.end());
   }
 
-  static void release(GLuint handle) noexcept {
-    glDeleteProgram(handle);
-  }
+  struct pending {
+    shader vert;
+    shader frag;
+    const gl::cache* storage = nullptr;
+    std::uint64_t key = 0;
+    bool parallel = false;
+  };
 
-private:
   resource<GLuint, program> handle_;
+  mutable std::unique_ptr<pending> pending_;
+  mutable std::vector<std::pair<std::string, GLint>> locations_;
 };
 
 }  // namespace gl
@@ -0,0 +1,124 @@
+#include <gl/queue.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace gl {
+namespace {
+
+bool compatible(const queue::packet& lhs, const queue::packet& rhs) noexcept {
+  return lhs.attribute >= 0 && lhs.framebuffer == rhs.framebuffer && lhs.program == rhs.program &&
+    lhs.array == rhs.array && lhs.texture == rhs.texture && lhs.mode == rhs.mode && lhs.type == rhs.type &&
+    lhs.count == rhs.count && lhs.offset == rhs.offset && lhs.attribute == rhs.attribute;
+}
+
+}  // namespace
+
+std::uint64_t queue::key(std::uint32_t framebuffer, std::uint32_t program, std::uint32_t array,
+  std::uint32_t texture, float depth) noexcept {
+  constexpr auto mask = [](unsigned bits) { return (std::uint64_t(1) << bits) - 1; };
+  const auto max = static_cast<float>(mask(depth_bits));
+  const auto z = static_cast<std::uint64_t>(std::clamp(depth, 0.0f, 1.0f) * max);
+  auto key = framebuffer & mask(framebuffer_bits);
+  key = (key << program_bits) | (program & mask(program_bits));
+  key = (key << array_bits) | (array & mask(array_bits));
+  key = (key << texture_bits) | (texture & mask(texture_bits));
+  key = (key << depth_bits) | z;
+  return key;
+}
+
+void queue::submit(commands& list, GLuint* instances, GLuint buffer, GLintptr offset) {
+  last_ = {};
+  last_.packets = packets_.size();
+  if (packets_.empty()) {
+    return;
+  }
+  sort();
+
+  // Write the instance indices of all packets in sorted order, so that merged runs are contiguous.
+  for (std::size_t i = 0; i < order_.size(); i++) {
+    instances[i] = packets_[order_[i]].instance;
+  }
+  for (std::size_t i = 0; i < order_.size();) {
+    const auto& packet = packets_[order_[i]];
+    auto j = i + 1;
+    while (j < order_.size() && compatible(packet, packets_[order_[j]])) {
+      j++;
+    }
+    draw(list, packet, buffer, static_cast<GLsizei>(j - i), offset + static_cast<GLintptr>(i * sizeof(GLuint)));
+    i = j;
+  }
+  packets_.clear();
+}
+
+void queue::submit(commands& list, stream& stream) {
+  if (packets_.empty()) {
+    last_ = {};
+    return;
+  }
+  const auto region = stream.map(static_cast<GLsizeiptr>(packets_.size() * sizeof(GLuint)), sizeof(GLuint));
+  submit(list, static_cast<GLuint*>(region.data), stream, region.offset);
+  stream.unmap();
+}
+
+void queue::sort() {
+  // Least significant digit radix sort with 8-bit digits. Passes where all keys share a digit are skipped.
+  const auto size = packets_.size();
+  keys_.resize(size);
+  order_.resize(size);
+  keys_scratch_.resize(size);
+  order_scratch_.resize(size);
+  for (std::size_t i = 0; i < size; i++) {
+    keys_[i] = packets_[i].key;
+    order_[i] = static_cast<std::uint32_t>(i);
+  }
+  std::array<std::array<std::uint32_t, 256>, 8> histograms = {};
+  for (const auto key : keys_) {
+    for (std::size_t pass = 0; pass < 8; pass++) {
+      histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+  }
+  for (std::size_t pass = 0; pass < 8; pass++) {
+    auto& histogram = histograms[pass];
+    const auto shift = pass * 8;
+    if (histogram[(keys_[0] >> shift) & 0xFF] == size) {
+      continue;
+    }
+    std::uint32_t offset = 0;
+    for (auto& count : histogram) {
+      offset += std::exchange(count, offset);
+    }
+    for (std::size_t i = 0; i < size; i++) {
+      const auto index = histogram[(keys_[i] >> shift) & 0xFF]++;
+      keys_scratch_[index] = keys_[i];
+      order_scratch_[index] = order_[i];
+    }
+    keys_.swap(keys_scratch_);
+    order_.swap(order_scratch_);
+  }
+}
+
+void queue::draw(commands& list, const packet& packet, GLuint buffer, GLsizei instances, GLintptr instance_offset) {
+  list.bind_framebuffer(GL_DRAW_FRAMEBUFFER, packet.framebuffer);
+  list.use_program(packet.program);
+  list.bind_vertex_array(packet.array);
+  if (packet.texture) {
+    list.bind_texture(0, GL_TEXTURE_2D, packet.texture);
+  }
+  if (packet.attribute >= 0) {
+    // Point the instance index attribute at the first index of the run.
+    const auto attribute = static_cast<GLuint>(packet.attribute);
+    list.vertex_attrib_ipointer(attribute, 1, GL_UNSIGNED_INT, 0, buffer, instance_offset, 1);
+  }
+  last_.draws++;
+
+  // Instanced draws are recorded with an instance count, others with 0.
+  const auto count = instances > 1 || packet.attribute >= 0 ? instances : 0;
+  if (packet.type) {
+    list.draw_elements_instanced(packet.mode, packet.count, packet.type, packet.offset, count);
+  } else {
+    list.draw_arrays_instanced(packet.mode, static_cast<GLint>(packet.offset), packet.count, count);
+  }
+}
+
+}  // namespace gl
@@ -0,0 +1,89 @@
+#pragma once
+#include <gl/commands.h>
+#include <gl/stream.h>
+#include <cstdint>
+#include <vector>
+
+namespace gl {
+
+// Sorted draw command queue.
+//
+// Clients push draw packets with a 64-bit sort key during a frame. submit() radix sorts the packets,
+// merges consecutive packets that only differ in their instance index into instanced draws and records
+// the binds and draws into a gl::commands list. The list replays binds through gl::state, so that only
+// changed bindings reach the driver.
+//
+// Merged draws provide the instance index of each packet to the vertex shader through an integer
+// attribute with a divisor of 1 (e.g. "in uint instance;"), which can be used to fetch per-object data.
+// The instance indices are written to a region of the per-frame stream buffer (see context::stream()).
+class queue {
+public:
+  // Draw packet. Indexed draws set type to the index type and offset to the byte offset of the first index.
+  // Non-indexed draws set type to 0 and offset to the first vertex.
+  struct packet {
+    std::uint64_t key = 0;
+    GLuint framebuffer = 0;
+    GLuint program = 0;
+    GLuint array = 0;
+    GLuint texture = 0;
+    GLenum mode = GL_TRIANGLES;
+    GLenum type = GL_UNSIGNED_INT;
+    GLsizei count = 0;
+    GLintptr offset = 0;
+
+    // Location of the per-instance index attribute in the vertex array object or -1 to disable merging.
+    GLint attribute = -1;
+    GLuint instance = 0;
+  };
+
+  struct statistics {
+    std::size_t packets = 0;
+    std::size_t draws = 0;
+  };
+
+  // Sort key layout from the most to the least significant bits.
+  static constexpr unsigned framebuffer_bits = 4;
+  static constexpr unsigned program_bits = 12;
+  static constexpr unsigned array_bits = 12;
+  static constexpr unsigned texture_bits = 12;
+  static constexpr unsigned depth_bits = 24;
+
+  // Builds a sort key from small, dense identifiers (e.g. registration indices) and a depth in [0, 1].
+  // Packets are sorted by framebuffer, program, vertex array, texture and depth in that order.
+  static std::uint64_t key(std::uint32_t framebuffer, std::uint32_t program, std::uint32_t array,
+    std::uint32_t texture, float depth) noexcept;
+
+  void push(const packet& packet) {
+    packets_.push_back(packet);
+  }
+
+  // Sorts and merges the queued packets, appends the draws to the list and clears the queue. The instance
+  // indices of the packets are written in sorted order to instances, which must have room for size()
+  // indices and is read by the draws from offset in buffer (e.g. a mapped region of a gl::stream).
+  // Does not call OpenGL ES, so that queues can be submitted by tasks of the jobs pool.
+  void submit(commands& list, GLuint* instances, GLuint buffer, GLintptr offset);
+
+  // Submits with the instance indices written to a region of the stream. Must be called with a current context.
+  void submit(commands& list, stream& stream);
+
+  const statistics& last() const noexcept {
+    return last_;
+  }
+
+  std::size_t size() const noexcept {
+    return packets_.size();
+  }
+
+private:
+  void sort();
+  void draw(commands& list, const packet& packet, GLuint buffer, GLsizei instances, GLintptr instance_offset);
+
+  std::vector<packet> packets_;
+  std::vector<std::uint64_t> keys_;
+  std::vector<std::uint32_t> order_;
+  std::vector<std::uint64_t> keys_scratch_;
+  std::vector<std::uint32_t> order_scratch_;
+  statistics last_;
+};
+
+}  // namespace gl
@@ -10,13 +10,13 @@ public:
   resource() noexcept = default;
   resource(T handle) noexcept : handle_(handle) {}
 
-  resource(resource&& other) noexcept : handle_(std::exchange(other.handle_, 0)) {}
+  resource(resource&& other) noexcept : handle_(std::exchange(other.handle_, T{})) {}
 
   resource& operator=(resource&& other) noexcept {
     if (handle_) {
       I::release(handle_);
     }
-    handle_ = std::exchange(other.handle_, 0);
+    handle_ = std::exchange(other.handle_, T{});
     return *this;
   }
 
@@ -26,15 +26,15 @@ public:
     }
   }
 
-  void reset(GLuint handle) noexcept {
+  void reset(T handle) noexcept {
     if (handle_) {
       I::release(handle_);
     }
     handle_ = handle;
   }
 
-  GLuint release() noexcept {
-    return std::exchange(handle_, 0);
+  T release() noexcept {
+    return std::exchange(handle_, T{});
   }
 
   operator T() const noexcept {
@@ -66,7 +66,7 @@ public:
   }
 
 private:
-  T handle_ = 0;
+  T handle_ = {};
 };
 
 }  // namespace gl
@@ -6,31 +6,46 @@
 
 namespace gl {
 
+// Tag for constructors that submit work without waiting for the result.
+struct deferred_t {
+  explicit deferred_t() = default;
+};
+
+inline constexpr deferred_t deferred{};
+
 class shader {
 public:
   shader() noexcept = default;
 
-  explicit shader(std::string_view src, GLenum type) {
+  explicit shader(std::string_view src, GLenum type) : shader(src, type, deferred) {
+    wait();
+  }
+
+  // Submits the shader for compilation without querying the compile status.
+  explicit shader(std::string_view src, GLenum type, deferred_t) {
     handle_.reset(glCreateShader(type));
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not create shader object");
     }
 
     auto data = src.data();
     auto size = static_cast<GLint>(src.size());
     glShaderSource(handle_, 1, &data, &size);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not set shader source");
     }
 
     glCompileShader(handle_);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not compile the shader.");
     }
+  }
 
+  // Waits for the compilation to finish and throws on errors.
+  void wait() const {
     GLint success = GL_FALSE;
     glGetShaderiv(handle_, GL_COMPILE_STATUS, &success);
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not get shader compile status.");
     }
 
@@ -38,16 +53,16 @@ public:
       std::string info;
       GLsizei size = 0;
       glGetShaderiv(handle_, GL_INFO_LOG_LENGTH, &size);
-      if (!error()) {
+      if (!check()) {
         info.resize(size);
         glGetShaderInfoLog(handle_, size, &size, &info[0]);
-        if (!error()) {
+        if (!check()) {
           info.resize(size);
         } else {
           info.clear();
         }
       }
-      throw runtime_error("Shader compilation failed.\n" + info + "\n" + std::string(src));
+      throw runtime_error("Shader compilation failed.\n" + info + "\n" + source());
     }
   }
 
@@ -57,7 +72,7 @@ public:
     }
     GLsizei size = 0;
     glGetShaderiv(handle_, GL_SHADER_SOURCE_LENGTH, &size);
-    if (size) {
+    if (!size) {
       return{};
     }
     std::string src;
@@ -0,0 +1,244 @@
+#include <gl/state.h>
+
+namespace gl {
+namespace {
+
+thread_local state* current_state = nullptr;
+
+bool forget(GLuint& value, GLsizei size, const GLuint* names) noexcept {
+  for (GLsizei i = 0; i < size; i++) {
+    if (value == names[i]) {
+      value = state::unknown;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <std::size_t N>
+void forget(std::array<GLuint, N>& values, GLsizei size, const GLuint* names) noexcept {
+  for (auto& value : values) {
+    forget(value, size, names);
+  }
+}
+
+}  // namespace
+
+state* state::current() noexcept {
+  return current_state;
+}
+
+void state::current(state* state) noexcept {
+  current_state = state;
+}
+
+void state::reset() noexcept {
+  program_ = unknown;
+  array_ = unknown;
+  buffers_.fill(unknown);
+  elements_ = unknown;
+  ranges_.fill({});
+  unit_ = unknown;
+  for (auto& unit : textures_) {
+    unit.fill(unknown);
+  }
+  read_framebuffer_ = unknown;
+  draw_framebuffer_ = unknown;
+  capabilities_.fill(-1);
+  viewport_ = { -1, -1, -1, -1 };
+}
+
+void state::use_program(GLuint program) noexcept {
+  if (update(program_, program)) {
+    glUseProgram(program);
+  }
+}
+
+void state::bind_vertex_array(GLuint array) noexcept {
+  if (update(array_, array)) {
+    glBindVertexArray(array);
+
+    // Each vertex array object has its own element array buffer binding.
+    elements_ = unknown;
+  }
+}
+
+void state::bind_buffer(GLenum target, GLuint buffer) noexcept {
+  auto binding = target == GL_ELEMENT_ARRAY_BUFFER ? &elements_ : this->buffer(target);
+  if (!binding || update(*binding, buffer)) {
+    if (!binding) {
+      frame_.calls++;
+    }
+    glBindBuffer(target, buffer);
+  }
+}
+
+void state::bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) noexcept {
+  if (target != GL_UNIFORM_BUFFER || index >= blocks) {
+    frame_.calls++;
+    if (const auto binding = this->buffer(target)) {
+      *binding = buffer;
+    }
+    glBindBufferRange(target, index, buffer, offset, size);
+    return;
+  }
+  if (update(ranges_[index], { buffer, offset, size })) {
+    // Binding a range also changes the generic binding point.
+    buffers_[5] = buffer;
+    glBindBufferRange(target, index, buffer, offset, size);
+  }
+}
+
+void state::bind_texture(GLuint unit, GLenum target, GLuint texture) noexcept {
+  const auto index = this->texture(target);
+  if (unit >= units || index < 0) {
+    frame_.calls++;
+    unit_ = unknown;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(target, texture);
+    return;
+  }
+  if (textures_[unit][index] == texture) {
+    frame_.elided++;
+    return;
+  }
+  if (update(unit_, unit)) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+  }
+  textures_[unit][index] = texture;
+  frame_.calls++;
+  glBindTexture(target, texture);
+}
+
+void state::bind_framebuffer(GLenum target, GLuint framebuffer) noexcept {
+  switch (target) {
+  case GL_FRAMEBUFFER:
+    if (read_framebuffer_ == framebuffer && draw_framebuffer_ == framebuffer) {
+      frame_.elided++;
+      return;
+    }
+    read_framebuffer_ = framebuffer;
+    draw_framebuffer_ = framebuffer;
+    frame_.calls++;
+    glBindFramebuffer(target, framebuffer);
+    return;
+  case GL_READ_FRAMEBUFFER:
+    if (update(read_framebuffer_, framebuffer)) {
+      glBindFramebuffer(target, framebuffer);
+    }
+    return;
+  case GL_DRAW_FRAMEBUFFER:
+    if (update(draw_framebuffer_, framebuffer)) {
+      glBindFramebuffer(target, framebuffer);
+    }
+    return;
+  }
+  frame_.calls++;
+  glBindFramebuffer(target, framebuffer);
+}
+
+void state::enable(GLenum capability, bool enable) noexcept {
+  const auto index = this->capability(capability);
+  if (index < 0 || update(capabilities_[index], enable ? 1 : 0)) {
+    if (index < 0) {
+      frame_.calls++;
+    }
+    if (enable) {
+      glEnable(capability);
+    } else {
+      glDisable(capability);
+    }
+  }
+}
+
+void state::viewport(GLint x, GLint y, GLsizei cx, GLsizei cy) noexcept {
+  if (update(viewport_, { x, y, cx, cy })) {
+    glViewport(x, y, cx, cy);
+  }
+}
+
+void state::end_frame() noexcept {
+  last_ = frame_;
+  total_.calls += frame_.calls;
+  total_.elided += frame_.elided;
+  frame_ = {};
+  frames_++;
+}
+
+void state::forget_program(GLuint program) noexcept {
+  if (const auto state = current_state) {
+    if (state->program_ == program) {
+      state->program_ = unknown;
+    }
+  }
+}
+
+void state::forget_arrays(GLsizei size, const GLuint* arrays) noexcept {
+  if (const auto state = current_state) {
+    if (forget(state->array_, size, arrays)) {
+      state->elements_ = unknown;
+    }
+  }
+}
+
+void state::forget_buffers(GLsizei size, const GLuint* buffers) noexcept {
+  if (const auto state = current_state) {
+    forget(state->buffers_, size, buffers);
+    forget(state->elements_, size, buffers);
+    for (auto& range : state->ranges_) {
+      forget(range.buffer, size, buffers);
+    }
+  }
+}
+
+void state::forget_textures(GLsizei size, const GLuint* textures) noexcept {
+  if (const auto state = current_state) {
+    for (auto& unit : state->textures_) {
+      forget(unit, size, textures);
+    }
+  }
+}
+
+void state::forget_framebuffers(GLsizei size, const GLuint* framebuffers) noexcept {
+  if (const auto state = current_state) {
+    forget(state->read_framebuffer_, size, framebuffers);
+    forget(state->draw_framebuffer_, size, framebuffers);
+  }
+}
+
+GLuint* state::buffer(GLenum target) noexcept {
+  switch (target) {
+  case GL_ARRAY_BUFFER: return &buffers_[0];
+  case GL_COPY_READ_BUFFER: return &buffers_[1];
+  case GL_COPY_WRITE_BUFFER: return &buffers_[2];
+  case GL_PIXEL_PACK_BUFFER: return &buffers_[3];
+  case GL_PIXEL_UNPACK_BUFFER: return &buffers_[4];
+  case GL_UNIFORM_BUFFER: return &buffers_[5];
+  case GL_TRANSFORM_FEEDBACK_BUFFER: return &buffers_[6];
+  }
+  return nullptr;
+}
+
+int state::texture(GLenum target) const noexcept {
+  switch (target) {
+  case GL_TEXTURE_2D: return 0;
+  case GL_TEXTURE_3D: return 1;
+  case GL_TEXTURE_2D_ARRAY: return 2;
+  case GL_TEXTURE_CUBE_MAP: return 3;
+  }
+  return -1;
+}
+
+int state::capability(GLenum capability) const noexcept {
+  switch (capability) {
+  case GL_BLEND: return 0;
+  case GL_DEPTH_TEST: return 1;
+  case GL_CULL_FACE: return 2;
+  case GL_SCISSOR_TEST: return 3;
+  case GL_STENCIL_TEST: return 4;
+  case GL_POLYGON_OFFSET_FILL: return 5;
+  }
+  return -1;
+}
+
+}  // namespace gl
@@ -0,0 +1,209 @@
+#pragma once
+#include <GLES3/gl3.h>
+#include <array>
+#include <cstdint>
+
+namespace gl {
+
+// Shadow copy of the binding and capability state of a context.
+//
+// Binds routed through this class skip calls that would not change the context state. Calls made directly
+// to OpenGL ES bypass the shadow copy and must be followed by reset(). Each context has its own state object,
+// which is made current for the thread that uses the context.
+class state {
+public:
+  // Value of bindings that are not known.
+  static constexpr GLuint unknown = ~0U;
+
+  // Number of tracked texture units.
+  static constexpr std::size_t units = 16;
+
+  // Number of tracked indexed uniform buffer binding points.
+  static constexpr std::size_t blocks = 24;
+
+  struct counters {
+    std::uint64_t calls = 0;
+    std::uint64_t elided = 0;
+  };
+
+  state() noexcept {
+    reset();
+  }
+
+  state(state&& other) = delete;
+  state& operator=(state&& other) = delete;
+
+  // Returns the state of the context on the calling thread or nullptr.
+  static state* current() noexcept;
+
+  // Sets the state of the context on the calling thread.
+  static void current(state* state) noexcept;
+
+  // Marks all state as unknown.
+  void reset() noexcept;
+
+  void use_program(GLuint program) noexcept;
+  void bind_vertex_array(GLuint array) noexcept;
+  void bind_buffer(GLenum target, GLuint buffer) noexcept;
+  void bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) noexcept;
+  void bind_texture(GLuint unit, GLenum target, GLuint texture) noexcept;
+  void bind_framebuffer(GLenum target, GLuint framebuffer) noexcept;
+  void enable(GLenum capability, bool enable) noexcept;
+  void viewport(GLint x, GLint y, GLsizei cx, GLsizei cy) noexcept;
+
+  // Returns the tracked viewport. The size is negative when the viewport is not known.
+  const std::array<GLint, 4>& viewport() const noexcept {
+    return viewport_;
+  }
+
+  // Returns the counters of the current frame.
+  const counters& frame() const noexcept {
+    return frame_;
+  }
+
+  // Returns the counters of the last completed frame.
+  const counters& last() const noexcept {
+    return last_;
+  }
+
+  // Returns the counters accumulated over all completed frames.
+  const counters& total() const noexcept {
+    return total_;
+  }
+
+  std::uint64_t frames() const noexcept {
+    return frames_;
+  }
+
+  // Completes the current frame counters.
+  void end_frame() noexcept;
+
+  // Forgets deleted objects in the state of the calling thread.
+  static void forget_program(GLuint program) noexcept;
+  static void forget_arrays(GLsizei size, const GLuint* arrays) noexcept;
+  static void forget_buffers(GLsizei size, const GLuint* buffers) noexcept;
+  static void forget_textures(GLsizei size, const GLuint* textures) noexcept;
+  static void forget_framebuffers(GLsizei size, const GLuint* framebuffers) noexcept;
+
+private:
+  // Returns true and counts the call when the value changed.
+  template <typename T>
+  bool update(T& current, const T& value) noexcept {
+    if (current == value) {
+      frame_.elided++;
+      return false;
+    }
+    current = value;
+    frame_.calls++;
+    return true;
+  }
+
+  GLuint* buffer(GLenum target) noexcept;
+  int texture(GLenum target) const noexcept;
+  int capability(GLenum capability) const noexcept;
+
+  GLuint program_;
+  GLuint array_;
+
+  // Buffer bindings except for GL_ELEMENT_ARRAY_BUFFER, which is part of the vertex array object state.
+  std::array<GLuint, 7> buffers_;
+  GLuint elements_;
+
+  // Indexed uniform buffer bindings.
+  struct range {
+    GLuint buffer = unknown;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+
+    bool operator==(const range& other) const noexcept {
+      return buffer == other.buffer && offset == other.offset && size == other.size;
+    }
+  };
+  std::array<range, blocks> ranges_;
+
+  GLuint unit_;
+  std::array<std::array<GLuint, 4>, units> textures_;
+
+  GLuint read_framebuffer_;
+  GLuint draw_framebuffer_;
+
+  // Capabilities: 0 disabled, 1 enabled, -1 unknown.
+  std::array<int, 6> capabilities_;
+  std::array<GLint, 4> viewport_;
+
+  counters frame_;
+  counters last_;
+  counters total_;
+  std::uint64_t frames_ = 0;
+};
+
+// Helpers that route calls through the state of the calling thread when there is one.
+
+inline void use_program(GLuint program) noexcept {
+  if (const auto state = state::current()) {
+    state->use_program(program);
+  } else {
+    glUseProgram(program);
+  }
+}
+
+inline void bind_vertex_array(GLuint array) noexcept {
+  if (const auto state = state::current()) {
+    state->bind_vertex_array(array);
+  } else {
+    glBindVertexArray(array);
+  }
+}
+
+inline void bind_buffer(GLenum target, GLuint buffer) noexcept {
+  if (const auto state = state::current()) {
+    state->bind_buffer(target, buffer);
+  } else {
+    glBindBuffer(target, buffer);
+  }
+}
+
+inline void bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) noexcept {
+  if (const auto state = state::current()) {
+    state->bind_buffer_range(target, index, buffer, offset, size);
+  } else {
+    glBindBufferRange(target, index, buffer, offset, size);
+  }
+}
+
+inline void bind_texture(GLuint unit, GLenum target, GLuint texture) noexcept {
+  if (const auto state = state::current()) {
+    state->bind_texture(unit, target, texture);
+  } else {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(target, texture);
+  }
+}
+
+inline void bind_framebuffer(GLenum target, GLuint framebuffer) noexcept {
+  if (const auto state = state::current()) {
+    state->bind_framebuffer(target, framebuffer);
+  } else {
+    glBindFramebuffer(target, framebuffer);
+  }
+}
+
+inline void enable(GLenum capability, bool enable) noexcept {
+  if (const auto state = state::current()) {
+    state->enable(capability, enable);
+  } else if (enable) {
+    glEnable(capability);
+  } else {
+    glDisable(capability);
+  }
+}
+
+inline void viewport(GLint x, GLint y, GLsizei cx, GLsizei cy) noexcept {
+  if (const auto state = state::current()) {
+    state->viewport(x, y, cx, cy);
+  } else {
+    glViewport(x, y, cx, cy);
+  }
+}
+
+}  // namespace gl
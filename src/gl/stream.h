@@ -0,0 +1,104 @@
+#pragma once
+#include <gl/buffers.h>
+#include <gl/error.h>
+#include <gl/state.h>
+#include <cstddef>
+#include <cstring>
+
+namespace gl {
+
+// Streaming buffer for per-frame dynamic data.
+//
+// The buffer is allocated once with one segment per frame in flight. Regions are sub-allocated from the
+// segment of the current frame and mapped with GL_MAP_UNSYNCHRONIZED_BIT. The segment is not fenced by the
+// stream itself: begin_frame() must be called with context::frame_index() before the first region of a frame
+// is mapped. The context waits for the fence of the frame that used the slot before, so a segment is never
+// written while the GPU still reads it.
+class stream {
+public:
+  struct region {
+    void* data = nullptr;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+  };
+
+  stream() noexcept = default;
+
+  // Allocates capacity bytes for each of the frames in flight. Must be called with a current context.
+  stream(GLsizeiptr capacity, std::size_t frames) : buffers_(1), capacity_(capacity), frames_(frames) {
+    // Use the copy write target to avoid changing the element array binding of the current vertex array object.
+    bind_buffer(GL_COPY_WRITE_BUFFER, buffers_[0]);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity_ * static_cast<GLsizeiptr>(frames_), nullptr, GL_STREAM_DRAW);
+    if (const auto ec = check()) {
+      throw system_error(ec, "Could not allocate stream buffer storage");
+    }
+  }
+
+  stream(stream&& other) noexcept = default;
+  stream& operator=(stream&& other) noexcept = default;
+
+  // Starts writing into the segment of the frame slot in [0, frames).
+  void begin_frame(std::size_t index) noexcept {
+    head_ = capacity_ * static_cast<GLsizeiptr>(index % frames_);
+    end_ = head_ + capacity_;
+  }
+
+  // Maps a region for writing. The region must be unmapped before it is used by draw calls.
+  region map(GLsizeiptr size, GLsizeiptr alignment = 16) {
+    const auto head = (head_ + alignment - 1) / alignment * alignment;
+    if (size <= 0 || head + size > end_) {
+      throw runtime_error("Stream buffer frame capacity exceeded.");
+    }
+    region region;
+    region.offset = head;
+    region.size = size;
+    bind_buffer(GL_COPY_WRITE_BUFFER, buffers_[0]);
+    region.data = glMapBufferRange(GL_COPY_WRITE_BUFFER, region.offset, size,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!region.data) {
+      throw system_error(error(), "Could not map stream buffer region");
+    }
+    head_ = head + size;
+    return region;
+  }
+
+  void unmap() {
+    bind_buffer(GL_COPY_WRITE_BUFFER, buffers_[0]);
+    const auto success = glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    if (!success) {
+      throw runtime_error("Stream buffer contents were corrupted while mapped.");
+    }
+  }
+
+  // Copies data into a new region and returns its offset.
+  GLintptr write(const void* data, GLsizeiptr size, GLsizeiptr alignment = 16) {
+    const auto region = map(size, alignment);
+    std::memcpy(region.data, data, static_cast<std::size_t>(size));
+    unmap();
+    return region.offset;
+  }
+
+  // Returns the capacity of a frame segment.
+  GLsizeiptr capacity() const noexcept {
+    return capacity_;
+  }
+
+  GLuint buffer() const noexcept {
+    return buffers_[0];
+  }
+
+  operator GLuint() const noexcept {
+    return buffers_[0];
+  }
+
+private:
+  buffers buffers_;
+  GLsizeiptr capacity_ = 0;
+  std::size_t frames_ = 1;
+
+  // Free range of the current frame segment.
+  GLsizeiptr head_ = 0;
+  GLsizeiptr end_ = 0;
+};
+
+}  // namespace gl
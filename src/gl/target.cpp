@@ -0,0 +1,146 @@
+#include <gl/target.h>
+#include <gl/error.h>
+#include <gl/state.h>
+#include <algorithm>
+#include <utility>
+
+namespace gl {
+
+target::target(const description& description) : description_(description) {
+  const auto samples = description_.samples;
+  glGenRenderbuffers(1, &color_);
+  glBindRenderbuffer(GL_RENDERBUFFER, color_);
+  glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, description_.format, description_.cx, description_.cy);
+  if (description_.depth != GL_NONE) {
+    glGenRenderbuffers(1, &depth_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, description_.depth, description_.cx, description_.cy);
+  }
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &framebuffer_);
+  bind_framebuffer(GL_DRAW_FRAMEBUFFER, framebuffer_);
+  glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_);
+  if (depth_) {
+    const auto attachment = description_.depth == GL_DEPTH24_STENCIL8 || description_.depth == GL_DEPTH32F_STENCIL8 ?
+      GL_DEPTH_STENCIL_ATTACHMENT : description_.depth == GL_STENCIL_INDEX8 ? GL_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+    glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, attachment, GL_RENDERBUFFER, depth_);
+  }
+  const auto status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
+  if (const auto ec = check()) {
+    release();
+    throw system_error(ec, "Could not create render target");
+  }
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    release();
+    throw runtime_error("Render target framebuffer is incomplete.");
+  }
+}
+
+target::target(target&& other) noexcept :
+  description_(other.description_), framebuffer_(std::exchange(other.framebuffer_, 0)),
+  color_(std::exchange(other.color_, 0)), depth_(std::exchange(other.depth_, 0)) {}
+
+target& target::operator=(target&& other) noexcept {
+  if (this != &other) {
+    release();
+    description_ = other.description_;
+    framebuffer_ = std::exchange(other.framebuffer_, 0);
+    color_ = std::exchange(other.color_, 0);
+    depth_ = std::exchange(other.depth_, 0);
+  }
+  return *this;
+}
+
+target::~target() {
+  release();
+}
+
+void target::invalidate(bool color, bool depth) const noexcept {
+  GLenum attachments[2] = {};
+  GLsizei size = 0;
+  if (color) {
+    attachments[size++] = GL_COLOR_ATTACHMENT0;
+  }
+  if (depth && depth_) {
+    attachments[size++] = description_.depth == GL_DEPTH_COMPONENT16 || description_.depth == GL_DEPTH_COMPONENT24 ||
+        description_.depth == GL_DEPTH_COMPONENT32F ? GL_DEPTH_ATTACHMENT :
+      description_.depth == GL_STENCIL_INDEX8 ? GL_STENCIL_ATTACHMENT : GL_DEPTH_STENCIL_ATTACHMENT;
+  }
+  if (size) {
+    bind_framebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glInvalidateFramebuffer(GL_READ_FRAMEBUFFER, size, attachments);
+  }
+}
+
+GLsizei target::samples(GLenum format, GLsizei requested) noexcept {
+  if (requested <= 1) {
+    return 0;
+  }
+  GLint max = 0;
+  glGetIntegerv(GL_MAX_SAMPLES, &max);
+  GLint count = 0;
+  glGetInternalformativ(GL_RENDERBUFFER, format, GL_NUM_SAMPLE_COUNTS, 1, &count);
+  if (count <= 0) {
+    return std::min(requested, static_cast<GLsizei>(max > 1 ? max : 0));
+  }
+
+  // Supported sample counts are returned in descending order.
+  std::vector<GLint> counts(static_cast<std::size_t>(count));
+  glGetInternalformativ(GL_RENDERBUFFER, format, GL_SAMPLES, count, counts.data());
+  for (const auto samples : counts) {
+    if (samples <= requested && samples <= max) {
+      return samples > 1 ? samples : 0;
+    }
+  }
+
+  // Use the lowest supported count when all counts exceed the requested one.
+  return counts.back() > 1 && counts.back() <= max ? counts.back() : 0;
+}
+
+void target::release() noexcept {
+  if (framebuffer_) {
+    state::forget_framebuffers(1, &framebuffer_);
+    glDeleteFramebuffers(1, &framebuffer_);
+    framebuffer_ = 0;
+  }
+  if (depth_) {
+    glDeleteRenderbuffers(1, &depth_);
+    depth_ = 0;
+  }
+  if (color_) {
+    glDeleteRenderbuffers(1, &color_);
+    color_ = 0;
+  }
+}
+
+std::shared_ptr<target> targets::acquire(const target::description& description) {
+  for (auto& entry : entries_) {
+    if (entry.target.use_count() == 1 && entry.target->info() == description) {
+      entry.frame = frame_;
+      return entry.target;
+    }
+  }
+  entries_.push_back({ std::make_shared<target>(description), frame_ });
+  return entries_.back().target;
+}
+
+void targets::end_frame() noexcept {
+  frame_++;
+  for (auto& entry : entries_) {
+    if (entry.target.use_count() > 1) {
+      entry.frame = frame_;
+    }
+  }
+  entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [this](const entry& entry) {
+    return entry.target.use_count() == 1 && frame_ - entry.frame > lifetime;
+  }), entries_.end());
+}
+
+void targets::clear() noexcept {
+  entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const entry& entry) {
+    return entry.target.use_count() == 1;
+  }), entries_.end());
+}
+
+}  // namespace gl
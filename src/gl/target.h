@@ -0,0 +1,97 @@
+#pragma once
+#include <GLES3/gl3.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace gl {
+
+// Offscreen render target with a color and an optional depth/stencil renderbuffer.
+class target {
+public:
+  struct description {
+    GLsizei cx = 0;
+    GLsizei cy = 0;
+    GLenum format = GL_RGBA8;
+    GLsizei samples = 0;
+
+    // Depth/stencil renderbuffer format or GL_NONE.
+    GLenum depth = GL_DEPTH24_STENCIL8;
+
+    bool operator==(const description& other) const noexcept {
+      return cx == other.cx && cy == other.cy && format == other.format && samples == other.samples &&
+        depth == other.depth;
+    }
+  };
+
+  target() noexcept = default;
+
+  // Creates the renderbuffers and the framebuffer. Throws when the framebuffer is incomplete.
+  explicit target(const description& description);
+
+  target(target&& other) noexcept;
+  target& operator=(target&& other) noexcept;
+
+  ~target();
+
+  // Discards the attachment contents. Use after the target was resolved or read to avoid writing the
+  // attachments back to memory on tiled renderers. Binds the framebuffer to GL_READ_FRAMEBUFFER.
+  void invalidate(bool color = true, bool depth = true) const noexcept;
+
+  const description& info() const noexcept {
+    return description_;
+  }
+
+  GLuint framebuffer() const noexcept {
+    return framebuffer_;
+  }
+
+  operator GLuint() const noexcept {
+    return framebuffer_;
+  }
+
+  // Returns the highest supported sample count for the format that does not exceed the requested count or the
+  // lowest supported count when there is none. Returns 0 when multisampling is not requested or not supported.
+  static GLsizei samples(GLenum format, GLsizei requested) noexcept;
+
+private:
+  void release() noexcept;
+
+  description description_;
+  GLuint framebuffer_ = 0;
+  GLuint color_ = 0;
+  GLuint depth_ = 0;
+};
+
+// Pool of render targets keyed by their description.
+//
+// Acquired targets stay reserved while a reference is held. Released targets are reused by later requests
+// with the same description and deleted when they were not used for a number of frames.
+class targets {
+public:
+  // Number of frames an unused target is kept in the pool.
+  static constexpr std::uint64_t lifetime = 60;
+
+  std::shared_ptr<target> acquire(const target::description& description);
+
+  // Deletes targets that were not acquired recently.
+  void end_frame() noexcept;
+
+  // Deletes all targets that are not referenced.
+  void clear() noexcept;
+
+  std::size_t size() const noexcept {
+    return entries_.size();
+  }
+
+private:
+  struct entry {
+    std::shared_ptr<gl::target> target;
+    std::uint64_t frame = 0;
+  };
+
+  std::vector<entry> entries_;
+  std::uint64_t frame_ = 0;
+};
+
+}  // namespace gl
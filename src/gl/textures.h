@@ -1,7 +1,9 @@
 #pragma once
 #include <gl/error.h>
+#include <gl/state.h>
 #include <GLES3/gl3.h>
 #include <memory>
+#include <utility>
 
 namespace gl {
 
@@ -11,15 +13,16 @@ public:
 
   explicit textures(std::size_t size) : handles_(std::make_unique<GLuint[]>(size)), size_(size) {
     glGenTextures(static_cast<GLsizei>(size_), handles_.get());
-    if (const auto ec = error()) {
+    if (const auto ec = check()) {
       throw system_error(ec, "Could not generate texture names");
     }
   }
 
-  textures(textures&& other) noexcept : size_(std::exchange(other.size_, 0)), handles_(std::move(other.handles_)) {}
+  textures(textures&& other) noexcept : handles_(std::move(other.handles_)), size_(std::exchange(other.size_, 0)) {}
 
   textures& operator=(textures&& other) noexcept {
     if (handles_) {
+      state::forget_textures(static_cast<GLsizei>(size_), handles_.get());
       glDeleteTextures(static_cast<GLsizei>(size_), handles_.get());
     }
     size_ = std::exchange(other.size_, 0);
@@ -29,6 +32,7 @@ public:
 
   ~textures() {
     if (handles_) {
+      state::forget_textures(static_cast<GLsizei>(size_), handles_.get());
       glDeleteTextures(static_cast<GLsizei>(size_), handles_.get());
     }
   }
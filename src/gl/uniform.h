@@ -0,0 +1,154 @@
+#pragma once
+#include <gl/buffers.h>
+#include <gl/error.h>
+#include <gl/state.h>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace gl {
+namespace std140 {
+
+// Types with std140 size and alignment. Array elements must use element<T>.
+
+struct alignas(8) vec2 {
+  float x = 0.0f;
+  float y = 0.0f;
+};
+
+// A vec3 is 16 byte aligned, but a following scalar is packed into its last 4 bytes. Declare vec3 members
+// as alignas(16) std140::vec3, since a C++ type can't be 16 byte aligned and 12 bytes large.
+struct vec3 {
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+};
+
+struct alignas(16) vec4 {
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+  float w = 0.0f;
+};
+
+struct alignas(16) ivec4 {
+  int x = 0;
+  int y = 0;
+  int z = 0;
+  int w = 0;
+};
+
+// Column major 4x4 matrix.
+struct alignas(16) mat4 {
+  vec4 columns[4] = {
+    { 1.0f, 0.0f, 0.0f, 0.0f },
+    { 0.0f, 1.0f, 0.0f, 0.0f },
+    { 0.0f, 0.0f, 1.0f, 0.0f },
+    { 0.0f, 0.0f, 0.0f, 1.0f },
+  };
+};
+
+// Array element padded to 16 bytes.
+template <typename T>
+struct alignas(16) element {
+  T value = {};
+};
+
+// Checks the constraints that a struct must satisfy to be copied into a std140 block.
+template <typename T>
+constexpr bool valid() noexcept {
+  return std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T> && sizeof(T) % 16 == 0;
+}
+
+}  // namespace std140
+
+// Verifies the std140 offset of a block member at compile time.
+#define GL_STD140_OFFSET(block, member, offset) \
+  static_assert(offsetof(block, member) == (offset), #block "::" #member " does not match its std140 offset.")
+
+namespace std140 {
+
+// Checks the layout of the GLSL block { vec3 position; float radius; vec3 color; }.
+struct vec3_layout {
+  alignas(16) vec3 position;
+  float radius = 0.0f;
+  alignas(16) vec3 color;
+};
+
+GL_STD140_OFFSET(vec3_layout, position, 0);
+GL_STD140_OFFSET(vec3_layout, radius, 12);
+GL_STD140_OFFSET(vec3_layout, color, 16);
+static_assert(sizeof(vec3) == 12 && sizeof(element<vec3>) == 16, "std140::vec3 does not match its std140 size.");
+
+}  // namespace std140
+
+// Uniform buffer with one or more instances of a std140 block.
+//
+// Instances are placed at GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so that each can be bound with glBindBufferRange.
+// All instances can be updated with a single glBufferSubData call.
+template <typename T>
+class uniform_buffer {
+public:
+  static_assert(std140::valid<T>(), "Uniform blocks must be standard layout, trivially copyable and 16 byte sized.");
+
+  uniform_buffer() noexcept = default;
+
+  explicit uniform_buffer(std::size_t size) : buffers_(1), size_(size) {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    const auto align = static_cast<std::size_t>(alignment > 0 ? alignment : 256);
+    stride_ = (sizeof(T) + align - 1) / align * align;
+    bind_buffer(GL_UNIFORM_BUFFER, buffers_[0]);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(stride_ * size_), nullptr, GL_DYNAMIC_DRAW);
+    if (const auto ec = check()) {
+      throw system_error(ec, "Could not allocate uniform buffer storage");
+    }
+  }
+
+  // Updates a single instance.
+  void update(const T& value, std::size_t index = 0) {
+    bind_buffer(GL_UNIFORM_BUFFER, buffers_[0]);
+    glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(stride_ * index), sizeof(T), &value);
+  }
+
+  // Updates the first size instances with a single upload.
+  void update(const T* values, std::size_t size) {
+    if (stride_ == sizeof(T)) {
+      bind_buffer(GL_UNIFORM_BUFFER, buffers_[0]);
+      glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(T) * size), values);
+      return;
+    }
+    staging_.resize(stride_ * size);
+    for (std::size_t i = 0; i < size; i++) {
+      std::memcpy(staging_.data() + stride_ * i, values + i, sizeof(T));
+    }
+    bind_buffer(GL_UNIFORM_BUFFER, buffers_[0]);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(staging_.size()), staging_.data());
+  }
+
+  // Binds an instance to a uniform block binding point.
+  void bind(GLuint binding, std::size_t index = 0) const noexcept {
+    bind_buffer_range(GL_UNIFORM_BUFFER, binding, buffers_[0], static_cast<GLintptr>(stride_ * index), sizeof(T));
+  }
+
+  std::size_t size() const noexcept {
+    return size_;
+  }
+
+  std::size_t stride() const noexcept {
+    return stride_;
+  }
+
+  operator GLuint() const noexcept {
+    return buffers_[0];
+  }
+
+private:
+  buffers buffers_;
+  std::size_t size_ = 0;
+  std::size_t stride_ = 0;
+  std::vector<unsigned char> staging_;
+};
+
+}  // namespace gl
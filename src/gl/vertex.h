@@ -0,0 +1,188 @@
+#pragma once
+#include <GLES3/gl3.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace gl {
+
+// 16-bit floating point attribute component (GL_HALF_FLOAT).
+class half {
+public:
+  constexpr half() noexcept = default;
+
+  half(float value) noexcept {
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+    const auto exponent = static_cast<std::int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    auto mantissa = bits & 0x7FFFFF;
+    if (((bits >> 23) & 0xFF) == 0xFF) {
+      // Infinity or NaN.
+      value_ = static_cast<std::uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    } else if (exponent >= 0x1F) {
+      // Overflow to infinity.
+      value_ = static_cast<std::uint16_t>(sign | 0x7C00);
+    } else if (exponent <= 0) {
+      // Denormal or zero.
+      if (exponent < -10) {
+        value_ = sign;
+      } else {
+        mantissa |= 0x800000;
+        const auto shift = static_cast<std::uint32_t>(14 - exponent);
+        const auto round = (std::uint32_t(1) << (shift - 1));
+        value_ = static_cast<std::uint16_t>(sign | ((mantissa + round) >> shift));
+      }
+    } else {
+      // Round to nearest. A mantissa overflow correctly carries into the exponent.
+      const auto result = (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+      value_ = static_cast<std::uint16_t>(sign | (result + ((mantissa >> 12) & 1)));
+    }
+  }
+
+  constexpr std::uint16_t bits() const noexcept {
+    return value_;
+  }
+
+private:
+  std::uint16_t value_ = 0;
+};
+
+// Normalized integer attribute component. Values in [0, 1] or [-1, 1] are mapped to the full integer range.
+template <typename T>
+class normalized {
+public:
+  static_assert(std::is_integral_v<T> && sizeof(T) <= 2, "Normalized components must be 8 or 16 bit integers.");
+
+  constexpr normalized() noexcept = default;
+
+  normalized(float value) noexcept :
+    value_(static_cast<T>(std::lround(std::clamp(value, std::is_signed_v<T> ? -1.0f : 0.0f, 1.0f) * max))) {}
+
+  constexpr T bits() const noexcept {
+    return value_;
+  }
+
+private:
+  static constexpr float max = static_cast<float>(std::numeric_limits<T>::max());
+  T value_ = 0;
+};
+
+using unorm8 = normalized<std::uint8_t>;
+using snorm8 = normalized<std::int8_t>;
+using unorm16 = normalized<std::uint16_t>;
+using snorm16 = normalized<std::int16_t>;
+
+// Four normalized signed components packed into 32 bits (GL_INT_2_10_10_10_REV), e.g. for normals and tangents.
+class packed {
+public:
+  constexpr packed() noexcept = default;
+
+  packed(float x, float y, float z, float w = 0.0f) noexcept :
+    value_(pack(x, 10, 0) | pack(y, 10, 10) | pack(z, 10, 20) | pack(w, 2, 30)) {}
+
+  constexpr std::uint32_t bits() const noexcept {
+    return value_;
+  }
+
+private:
+  static std::uint32_t pack(float value, unsigned bits, unsigned shift) noexcept {
+    const auto max = static_cast<float>((1 << (bits - 1)) - 1);
+    const auto mask = (std::uint32_t(1) << bits) - 1;
+    const auto integer = static_cast<std::int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * max));
+    return (static_cast<std::uint32_t>(integer) & mask) << shift;
+  }
+
+  std::uint32_t value_ = 0;
+};
+
+// Maps a vertex member type to its attribute format.
+template <typename T>
+struct vertex_format;
+
+template <GLenum Type, GLint Size, GLboolean Normalized, bool Integer>
+struct vertex_format_base {
+  static constexpr GLenum type = Type;
+  static constexpr GLint size = Size;
+  static constexpr GLboolean normalized = Normalized;
+  static constexpr bool integer = Integer;
+};
+
+// clang-format off
+template <> struct vertex_format<float> : vertex_format_base<GL_FLOAT, 1, GL_FALSE, false> {};
+template <> struct vertex_format<half> : vertex_format_base<GL_HALF_FLOAT, 1, GL_FALSE, false> {};
+template <> struct vertex_format<unorm8> : vertex_format_base<GL_UNSIGNED_BYTE, 1, GL_TRUE, false> {};
+template <> struct vertex_format<snorm8> : vertex_format_base<GL_BYTE, 1, GL_TRUE, false> {};
+template <> struct vertex_format<unorm16> : vertex_format_base<GL_UNSIGNED_SHORT, 1, GL_TRUE, false> {};
+template <> struct vertex_format<snorm16> : vertex_format_base<GL_SHORT, 1, GL_TRUE, false> {};
+template <> struct vertex_format<packed> : vertex_format_base<GL_INT_2_10_10_10_REV, 4, GL_TRUE, false> {};
+template <> struct vertex_format<std::uint8_t> : vertex_format_base<GL_UNSIGNED_BYTE, 1, GL_FALSE, true> {};
+template <> struct vertex_format<std::int8_t> : vertex_format_base<GL_BYTE, 1, GL_FALSE, true> {};
+template <> struct vertex_format<std::uint16_t> : vertex_format_base<GL_UNSIGNED_SHORT, 1, GL_FALSE, true> {};
+template <> struct vertex_format<std::int16_t> : vertex_format_base<GL_SHORT, 1, GL_FALSE, true> {};
+template <> struct vertex_format<std::uint32_t> : vertex_format_base<GL_UNSIGNED_INT, 1, GL_FALSE, true> {};
+template <> struct vertex_format<std::int32_t> : vertex_format_base<GL_INT, 1, GL_FALSE, true> {};
+// clang-format on
+
+template <typename T, std::size_t N>
+struct vertex_format<std::array<T, N>> : vertex_format<T> {
+  static_assert(N >= 1 && N <= 4 && vertex_format<T>::size == 1, "Vertex attributes have 1 to 4 components.");
+  static constexpr GLint size = static_cast<GLint>(N);
+};
+
+// Vertex attribute description.
+struct vertex_attribute {
+  const char* name = nullptr;
+  GLenum type = GL_FLOAT;
+  GLint size = 0;
+  GLboolean normalized = GL_FALSE;
+  bool integer = false;
+  std::size_t offset = 0;
+  std::size_t bytes = 0;
+};
+
+template <typename T>
+constexpr vertex_attribute make_vertex_attribute(const char* name, std::size_t offset) noexcept {
+  using format = vertex_format<T>;
+  return { name, format::type, format::size, format::normalized, format::integer, offset, sizeof(T) };
+}
+
+// Vertex layout. Specialize for vertex structs with a static constexpr std::array of attributes:
+//
+//   struct vertex {
+//     std::array<gl::half, 2> position;
+//     std::array<gl::unorm8, 4> color;
+//   };
+//
+//   template <>
+//   struct gl::vertex_layout<vertex> {
+//     static constexpr std::array attributes = {
+//       GL_VERTEX_ATTRIBUTE(vertex, position),
+//       GL_VERTEX_ATTRIBUTE(vertex, color),
+//     };
+//   };
+//
+// Attributes are matched to program attributes by name.
+template <typename Vertex>
+struct vertex_layout;
+
+#define GL_VERTEX_ATTRIBUTE(vertex, member) \
+  gl::make_vertex_attribute<decltype(vertex::member)>(#member, offsetof(vertex, member))
+
+// Verifies that all attributes lie within the vertex and are aligned to 4 bytes as required by some backends.
+template <typename Vertex>
+constexpr bool vertex_layout_valid() noexcept {
+  for (const auto& attribute : vertex_layout<Vertex>::attributes) {
+    if (attribute.offset + attribute.bytes > sizeof(Vertex) || attribute.offset % 4 != 0) {
+      return false;
+    }
+  }
+  return sizeof(Vertex) % 4 == 0;
+}
+
+}  // namespace gl
@@ -0,0 +1,96 @@
+#include "jobs.h"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace {
+
+// Pool whose task the calling thread is executing.
+thread_local const jobs* current = nullptr;
+
+}  // namespace
+
+jobs::jobs(std::size_t threads) {
+  if (!threads) {
+    threads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  for (std::size_t i = 1; i < threads; i++) {
+    workers_.emplace_back([this]() { loop(); });
+  }
+}
+
+jobs::~jobs() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  start_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void jobs::run(std::size_t count, const std::function<void(std::size_t index)>& task) {
+  assert(current != this && "jobs::run() must not be called from a task of the same pool");
+  if (!count) {
+    return;
+  }
+  std::unique_lock lock(mutex_);
+  task_ = &task;
+  next_ = 0;
+  count_ = count;
+  exception_ = nullptr;
+  generation_++;
+  if (count > 1) {
+    start_.notify_all();
+  }
+
+  // Help with the tasks and wait for the workers that are still busy.
+  work(lock);
+  done_.wait(lock, [this]() { return next_ >= count_ && !active_; });
+  task_ = nullptr;
+  if (exception_) {
+    std::rethrow_exception(std::exchange(exception_, nullptr));
+  }
+}
+
+void jobs::work(std::unique_lock<std::mutex>& lock) {
+  active_++;
+  while (next_ < count_) {
+    const auto index = next_++;
+    const auto task = task_;
+    lock.unlock();
+    const auto previous = std::exchange(current, this);
+    try {
+      (*task)(index);
+    }
+    catch (...) {
+      current = previous;
+      lock.lock();
+      if (!exception_) {
+        exception_ = std::current_exception();
+      }
+      next_ = count_;
+      continue;
+    }
+    current = previous;
+    lock.lock();
+  }
+  active_--;
+}
+
+void jobs::loop() {
+  std::size_t generation = 0;
+  std::unique_lock lock(mutex_);
+  while (true) {
+    start_.wait(lock, [&]() { return stopping_ || (generation_ != generation && next_ < count_); });
+    if (stopping_) {
+      return;
+    }
+    generation = generation_;
+    work(lock);
+    if (!active_) {
+      done_.notify_one();
+    }
+  }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool of worker threads for data parallel work on the render thread.
+//
+// run() splits a range of tasks across the workers and the calling thread and returns when all tasks are
+// finished. Tasks must not call OpenGL ES. Use one gl::commands list per task to record GL work and replay
+// the lists in task order afterwards.
+class jobs {
+public:
+  // Creates one worker per hardware thread except for the calling thread when threads is 0.
+  explicit jobs(std::size_t threads = 0);
+
+  jobs(jobs&& other) = delete;
+  jobs& operator=(jobs&& other) = delete;
+
+  ~jobs();
+
+  // Calls task(index) for each index in [0, count) and blocks until all calls returned.
+  // Rethrows the first exception thrown by a task. Must not be called from a task of the same pool,
+  // which would wait for itself.
+  void run(std::size_t count, const std::function<void(std::size_t index)>& task);
+
+  // Returns the number of threads that execute tasks, including the calling thread.
+  std::size_t threads() const noexcept {
+    return workers_.size() + 1;
+  }
+
+private:
+  void work(std::unique_lock<std::mutex>& lock);
+  void loop();
+
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  const std::function<void(std::size_t index)>* task_ = nullptr;
+  std::size_t next_ = 0;
+  std::size_t count_ = 0;
+  std::size_t active_ = 0;
+  std::size_t generation_ = 0;
+  std::exception_ptr exception_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
@@ -0,0 +1,141 @@
+#include <math/batch.h>
+#include <cstring>
+
+namespace math {
+namespace {
+
+#if defined(MATH_AVX)
+using batch = float8;
+constexpr std::size_t lanes = 8;
+#else
+using batch = float4;
+constexpr std::size_t lanes = 4;
+#endif
+
+// Writes column c of four objects, given as the rows of column c in lanes, to the output.
+void store(float4 r0, float4 r1, float4 r2, float4 r3, std::size_t column, std::byte* output, std::size_t stride) noexcept {
+  transpose(r0, r1, r2, r3);
+  const auto offset = column * 4 * sizeof(float);
+  r0.store(reinterpret_cast<float*>(output + offset));
+  r1.store(reinterpret_cast<float*>(output + stride + offset));
+  r2.store(reinterpret_cast<float*>(output + stride * 2 + offset));
+  r3.store(reinterpret_cast<float*>(output + stride * 3 + offset));
+}
+
+#if defined(MATH_AVX)
+void store(float8 r0, float8 r1, float8 r2, float8 r3, std::size_t column, std::byte* output, std::size_t stride) noexcept {
+  store(r0.low(), r1.low(), r2.low(), r3.low(), column, output, stride);
+  store(r0.high(), r1.high(), r2.high(), r3.high(), column, output + stride * 4, stride);
+}
+#endif
+
+}  // namespace
+
+void transforms::resize(std::size_t size) {
+  // New objects have the identity transform.
+  for (auto values : { &px, &py, &pz, &rx, &ry, &rz }) {
+    values->resize(size, 0.0f);
+  }
+  for (auto values : { &rw, &sx, &sy, &sz }) {
+    values->resize(size, 1.0f);
+  }
+}
+
+void transforms::set(std::size_t index, const vec3& position, const quat& rotation, const vec3& scale) noexcept {
+  px[index] = position.x;
+  py[index] = position.y;
+  pz[index] = position.z;
+  rx[index] = rotation.x;
+  ry[index] = rotation.y;
+  rz[index] = rotation.z;
+  rw[index] = rotation.w;
+  sx[index] = scale.x;
+  sy[index] = scale.y;
+  sz[index] = scale.z;
+}
+
+void multiply(const mat4& view_projection, const transforms& transforms, std::size_t first, std::size_t count,
+  void* output, std::size_t stride) noexcept {
+  // Matrix elements by row and column.
+  float vp[4][4];
+  for (auto c = 0; c < 4; c++) {
+    vp[0][c] = view_projection.columns[c].x;
+    vp[1][c] = view_projection.columns[c].y;
+    vp[2][c] = view_projection.columns[c].z;
+    vp[3][c] = view_projection.columns[c].w;
+  }
+
+  auto out = static_cast<std::byte*>(output);
+  const auto end = first + count;
+  auto i = first;
+  const auto one = batch::splat(1.0f);
+  const auto two = batch::splat(2.0f);
+  for (; i + lanes <= end; i += lanes, out += stride * lanes) {
+    // Rotation matrix elements of the objects in lanes.
+    const auto x = batch::loadu(transforms.rx.data() + i);
+    const auto y = batch::loadu(transforms.ry.data() + i);
+    const auto z = batch::loadu(transforms.rz.data() + i);
+    const auto w = batch::loadu(transforms.rw.data() + i);
+    const auto xx = x * x;
+    const auto yy = y * y;
+    const auto zz = z * z;
+    const auto xy = x * y;
+    const auto xz = x * z;
+    const auto yz = y * z;
+    const auto wx = w * x;
+    const auto wy = w * y;
+    const auto wz = w * z;
+
+    // Scaled world matrix columns. The last row is (0, 0, 0, 1).
+    const auto sx = batch::loadu(transforms.sx.data() + i);
+    const auto sy = batch::loadu(transforms.sy.data() + i);
+    const auto sz = batch::loadu(transforms.sz.data() + i);
+    const batch world[4][3] = {
+      { (one - two * (yy + zz)) * sx, two * (xy + wz) * sx, two * (xz - wy) * sx },
+      { two * (xy - wz) * sy, (one - two * (xx + zz)) * sy, two * (yz + wx) * sy },
+      { two * (xz + wy) * sz, two * (yz - wx) * sz, (one - two * (xx + yy)) * sz },
+      { batch::loadu(transforms.px.data() + i), batch::loadu(transforms.py.data() + i),
+        batch::loadu(transforms.pz.data() + i) },
+    };
+
+    // Each element of the product is the dot product of a view projection row and a world column.
+    for (std::size_t c = 0; c < 4; c++) {
+      const auto& column = world[c];
+      const auto element = [&](int r) {
+        auto value = batch::splat(vp[r][0]) * column[0] + batch::splat(vp[r][1]) * column[1] +
+          batch::splat(vp[r][2]) * column[2];
+        return c == 3 ? value + batch::splat(vp[r][3]) : value;
+      };
+      store(element(0), element(1), element(2), element(3), c, out, stride);
+    }
+  }
+
+  // Remaining objects.
+  for (; i < end; i++, out += stride) {
+    const vec3 position{ transforms.px[i], transforms.py[i], transforms.pz[i] };
+    const quat rotation{ transforms.rx[i], transforms.ry[i], transforms.rz[i], transforms.rw[i] };
+    const vec3 scale{ transforms.sx[i], transforms.sy[i], transforms.sz[i] };
+    const auto m = view_projection * mat4::transform(position, rotation, scale);
+    std::memcpy(out, &m, sizeof(m));
+  }
+}
+
+void multiply(const mat4& a, const mat4* b, std::size_t count, void* output, std::size_t stride) noexcept {
+  const auto a0 = a.columns[0].load();
+  const auto a1 = a.columns[1].load();
+  const auto a2 = a.columns[2].load();
+  const auto a3 = a.columns[3].load();
+  auto out = static_cast<std::byte*>(output);
+  for (std::size_t i = 0; i < count; i++, out += stride) {
+    for (std::size_t c = 0; c < 4; c++) {
+      const auto v = b[i].columns[c].load();
+      auto r = a0 * v.broadcast<0>();
+      r = madd(a1, v.broadcast<1>(), r);
+      r = madd(a2, v.broadcast<2>(), r);
+      r = madd(a3, v.broadcast<3>(), r);
+      r.store(reinterpret_cast<float*>(out + c * 4 * sizeof(float)));
+    }
+  }
+}
+
+}  // namespace math
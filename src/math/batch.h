@@ -0,0 +1,43 @@
+#pragma once
+#include <math/matrix.h>
+#include <cstddef>
+#include <vector>
+
+namespace math {
+
+// Object transforms in structure of arrays layout for batch processing.
+struct transforms {
+  // Positions.
+  std::vector<float> px;
+  std::vector<float> py;
+  std::vector<float> pz;
+
+  // Rotation quaternions.
+  std::vector<float> rx;
+  std::vector<float> ry;
+  std::vector<float> rz;
+  std::vector<float> rw;
+
+  // Scales.
+  std::vector<float> sx;
+  std::vector<float> sy;
+  std::vector<float> sz;
+
+  std::size_t size() const noexcept {
+    return px.size();
+  }
+
+  void resize(std::size_t size);
+  void set(std::size_t index, const vec3& position, const quat& rotation, const vec3& scale) noexcept;
+};
+
+// Computes view_projection * translation * rotation * scale for the objects in [first, first + count) and
+// writes the column major matrices to output, one every stride bytes (e.g. 64 for an instance buffer or the
+// uniform_buffer stride). Processes 8 (AVX), 4 (SSE, NEON) or 1 object per iteration.
+void multiply(const mat4& view_projection, const transforms& transforms, std::size_t first, std::size_t count,
+  void* output, std::size_t stride) noexcept;
+
+// Computes a * b[i] for count matrices and writes the results to output, one every stride bytes.
+void multiply(const mat4& a, const mat4* b, std::size_t count, void* output, std::size_t stride) noexcept;
+
+}  // namespace math
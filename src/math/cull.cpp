@@ -0,0 +1,111 @@
+#include <math/cull.h>
+#include <algorithm>
+
+namespace math {
+namespace {
+
+#if defined(MATH_AVX)
+using batch = float8;
+constexpr std::size_t lanes = 8;
+#else
+using batch = float4;
+constexpr std::size_t lanes = 4;
+#endif
+
+}  // namespace
+
+void spheres::resize(std::size_t size) {
+  for (auto values : { &cx, &cy, &cz, &radius }) {
+    values->resize(size, 0.0f);
+  }
+}
+
+void spheres::set(std::size_t index, const vec3& centre, float radius) noexcept {
+  cx[index] = centre.x;
+  cy[index] = centre.y;
+  cz[index] = centre.z;
+  this->radius[index] = radius;
+}
+
+frustum frustum::extract(const mat4& view_projection) noexcept {
+  // Matrix rows.
+  const auto& m = view_projection.columns;
+  const vec4 rows[4] = {
+    { m[0].x, m[1].x, m[2].x, m[3].x },
+    { m[0].y, m[1].y, m[2].y, m[3].y },
+    { m[0].z, m[1].z, m[2].z, m[3].z },
+    { m[0].w, m[1].w, m[2].w, m[3].w },
+  };
+
+  // A clip space position is inside when -w <= x, y, z <= w.
+  const auto w = rows[3].load();
+  const float4 planes[6] = {
+    w + rows[0].load(), w - rows[0].load(),
+    w + rows[1].load(), w - rows[1].load(),
+    w + rows[2].load(), w - rows[2].load(),
+  };
+
+  // Normalize the planes so that the plane equation returns the distance for the radius test.
+  frustum result;
+  for (auto i = 0; i < 6; i++) {
+    auto plane = vec4::store(planes[i]);
+    const auto length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    if (length > 0.0f) {
+      plane = vec4::store(planes[i] * float4::splat(1.0f / length));
+    }
+    result.planes[i] = plane;
+  }
+  return result;
+}
+
+std::size_t cull(const frustum& frustum, const spheres& spheres, std::size_t first, std::size_t count,
+  std::uint32_t* visible) noexcept {
+  batch planes[6][4];
+  for (auto i = 0; i < 6; i++) {
+    const auto& plane = frustum.planes[i];
+    planes[i][0] = batch::splat(plane.x);
+    planes[i][1] = batch::splat(plane.y);
+    planes[i][2] = batch::splat(plane.z);
+    planes[i][3] = batch::splat(plane.w);
+  }
+
+  std::size_t size = 0;
+  const auto end = first + count;
+  auto i = first;
+  for (; i + lanes <= end; i += lanes) {
+    const auto x = batch::loadu(spheres.cx.data() + i);
+    const auto y = batch::loadu(spheres.cy.data() + i);
+    const auto z = batch::loadu(spheres.cz.data() + i);
+    const auto r = batch::loadu(spheres.radius.data() + i);
+
+    // The smallest signed distance plus the radius is negative when a sphere is outside any plane.
+    auto distance = planes[0][0] * x + planes[0][1] * y + planes[0][2] * z + planes[0][3];
+    for (auto p = 1; p < 6; p++) {
+      distance = min(distance, planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3]);
+    }
+    const auto inside = ~negative(distance + r);
+
+    // Write all indices and only advance past the visible ones. The writes stay within the count processed so far.
+    for (std::size_t lane = 0; lane < lanes; lane++) {
+      visible[size] = static_cast<std::uint32_t>(i + lane);
+      size += static_cast<std::size_t>((inside >> lane) & 1);
+    }
+  }
+
+  // Remaining spheres.
+  for (; i < end; i++) {
+    const vec3 centre{ spheres.cx[i], spheres.cy[i], spheres.cz[i] };
+    auto distance = dot(centre, { frustum.planes[0].x, frustum.planes[0].y, frustum.planes[0].z }) +
+      frustum.planes[0].w;
+    for (auto p = 1; p < 6; p++) {
+      const auto& plane = frustum.planes[p];
+      distance = std::min(distance, dot(centre, { plane.x, plane.y, plane.z }) + plane.w);
+    }
+    if (!(distance + spheres.radius[i] < 0.0f)) {
+      visible[size++] = static_cast<std::uint32_t>(i);
+    }
+  }
+  return size;
+}
+
+}  // namespace math
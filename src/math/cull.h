@@ -0,0 +1,43 @@
+#pragma once
+#include <math/matrix.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace math {
+
+// Object bounding spheres in structure of arrays layout for batch processing.
+struct spheres {
+  // Centres.
+  std::vector<float> cx;
+  std::vector<float> cy;
+  std::vector<float> cz;
+
+  // Radii.
+  std::vector<float> radius;
+
+  std::size_t size() const noexcept {
+    return cx.size();
+  }
+
+  void resize(std::size_t size);
+  void set(std::size_t index, const vec3& centre, float radius) noexcept;
+};
+
+// View frustum as six normalized planes (x, y, z, w) with the normals pointing inside.
+// A point p is inside a plane when dot(p, plane.xyz) + plane.w >= 0.
+struct frustum {
+  vec4 planes[6];
+
+  // Extracts the left, right, bottom, top, near and far planes from a view projection matrix that maps to
+  // OpenGL clip space. The planes are in the space that the matrix transforms from.
+  static frustum extract(const mat4& view_projection) noexcept;
+};
+
+// Tests the spheres in [first, first + count) against the frustum and writes the indices of the spheres that
+// are inside or intersect all planes to visible in ascending order. Returns the number of written indices.
+// The visible array must have room for count indices. Tests 8 (AVX), 4 (SSE, NEON) or 1 sphere per iteration.
+std::size_t cull(const frustum& frustum, const spheres& spheres, std::size_t first, std::size_t count,
+  std::uint32_t* visible) noexcept;
+
+}  // namespace math
@@ -0,0 +1,193 @@
+#pragma once
+#include <math/simd.h>
+#include <cmath>
+
+namespace math {
+
+struct vec3 {
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+};
+
+inline vec3 operator+(const vec3& a, const vec3& b) noexcept {
+  return { a.x + b.x, a.y + b.y, a.z + b.z };
+}
+
+inline vec3 operator-(const vec3& a, const vec3& b) noexcept {
+  return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+inline vec3 operator*(const vec3& a, float s) noexcept {
+  return { a.x * s, a.y * s, a.z * s };
+}
+
+inline float dot(const vec3& a, const vec3& b) noexcept {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline vec3 cross(const vec3& a, const vec3& b) noexcept {
+  return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+inline vec3 normalize(const vec3& v) noexcept {
+  const auto length = std::sqrt(dot(v, v));
+  return length > 0.0f ? v * (1.0f / length) : v;
+}
+
+struct alignas(16) vec4 {
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+  float w = 0.0f;
+
+  float4 load() const noexcept {
+    return float4::load(&x);
+  }
+
+  static vec4 store(float4 value) noexcept {
+    vec4 result;
+    value.store(&result.x);
+    return result;
+  }
+};
+
+// Rotation quaternion.
+struct alignas(16) quat {
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+  float w = 1.0f;
+
+  // Rotation around the normalized axis in radians.
+  static quat rotation(const vec3& axis, float angle) noexcept {
+    const auto s = std::sin(angle * 0.5f);
+    return { axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f) };
+  }
+};
+
+inline quat operator*(const quat& a, const quat& b) noexcept {
+  return {
+    a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+    a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+    a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+    a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+  };
+}
+
+inline quat normalize(const quat& q) noexcept {
+  const auto length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+  return length > 0.0f ? quat{ q.x / length, q.y / length, q.z / length, q.w / length } : quat{};
+}
+
+// Column major 4x4 matrix with the memory layout of gl::std140::mat4.
+struct alignas(16) mat4 {
+  vec4 columns[4] = {
+    { 1.0f, 0.0f, 0.0f, 0.0f },
+    { 0.0f, 1.0f, 0.0f, 0.0f },
+    { 0.0f, 0.0f, 1.0f, 0.0f },
+    { 0.0f, 0.0f, 0.0f, 1.0f },
+  };
+
+  static mat4 translation(const vec3& t) noexcept {
+    mat4 m;
+    m.columns[3] = { t.x, t.y, t.z, 1.0f };
+    return m;
+  }
+
+  static mat4 scale(const vec3& s) noexcept {
+    mat4 m;
+    m.columns[0].x = s.x;
+    m.columns[1].y = s.y;
+    m.columns[2].z = s.z;
+    return m;
+  }
+
+  static mat4 rotation(const quat& q) noexcept {
+    const auto xx = q.x * q.x;
+    const auto yy = q.y * q.y;
+    const auto zz = q.z * q.z;
+    const auto xy = q.x * q.y;
+    const auto xz = q.x * q.z;
+    const auto yz = q.y * q.z;
+    const auto wx = q.w * q.x;
+    const auto wy = q.w * q.y;
+    const auto wz = q.w * q.z;
+    mat4 m;
+    m.columns[0] = { 1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f };
+    m.columns[1] = { 2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f };
+    m.columns[2] = { 2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f };
+    return m;
+  }
+
+  // Translation * rotation * scale.
+  static mat4 transform(const vec3& t, const quat& r, const vec3& s) noexcept {
+    auto m = rotation(r);
+    m.columns[0] = vec4::store(m.columns[0].load() * float4::splat(s.x));
+    m.columns[1] = vec4::store(m.columns[1].load() * float4::splat(s.y));
+    m.columns[2] = vec4::store(m.columns[2].load() * float4::splat(s.z));
+    m.columns[3] = { t.x, t.y, t.z, 1.0f };
+    return m;
+  }
+
+  // Right handed perspective projection to the OpenGL clip volume. The field of view is in radians.
+  static mat4 perspective(float fovy, float aspect, float znear, float zfar) noexcept {
+    const auto f = 1.0f / std::tan(fovy * 0.5f);
+    mat4 m;
+    m.columns[0] = { f / aspect, 0.0f, 0.0f, 0.0f };
+    m.columns[1] = { 0.0f, f, 0.0f, 0.0f };
+    m.columns[2] = { 0.0f, 0.0f, (zfar + znear) / (znear - zfar), -1.0f };
+    m.columns[3] = { 0.0f, 0.0f, 2.0f * zfar * znear / (znear - zfar), 0.0f };
+    return m;
+  }
+
+  static mat4 orthographic(float left, float right, float bottom, float top, float znear, float zfar) noexcept {
+    mat4 m;
+    m.columns[0] = { 2.0f / (right - left), 0.0f, 0.0f, 0.0f };
+    m.columns[1] = { 0.0f, 2.0f / (top - bottom), 0.0f, 0.0f };
+    m.columns[2] = { 0.0f, 0.0f, 2.0f / (znear - zfar), 0.0f };
+    m.columns[3] = { (left + right) / (left - right), (bottom + top) / (bottom - top), (znear + zfar) / (znear - zfar), 1.0f };
+    return m;
+  }
+
+  // Right handed view matrix.
+  static mat4 look_at(const vec3& eye, const vec3& center, const vec3& up) noexcept {
+    const auto f = normalize(center - eye);
+    const auto s = normalize(cross(f, up));
+    const auto u = cross(s, f);
+    mat4 m;
+    m.columns[0] = { s.x, u.x, -f.x, 0.0f };
+    m.columns[1] = { s.y, u.y, -f.y, 0.0f };
+    m.columns[2] = { s.z, u.z, -f.z, 0.0f };
+    m.columns[3] = { -dot(s, eye), -dot(u, eye), dot(f, eye), 1.0f };
+    return m;
+  }
+};
+
+inline vec4 operator*(const mat4& m, const vec4& v) noexcept {
+  const auto c = v.load();
+  auto r = m.columns[0].load() * c.broadcast<0>();
+  r = madd(m.columns[1].load(), c.broadcast<1>(), r);
+  r = madd(m.columns[2].load(), c.broadcast<2>(), r);
+  r = madd(m.columns[3].load(), c.broadcast<3>(), r);
+  return vec4::store(r);
+}
+
+inline mat4 operator*(const mat4& a, const mat4& b) noexcept {
+  const auto a0 = a.columns[0].load();
+  const auto a1 = a.columns[1].load();
+  const auto a2 = a.columns[2].load();
+  const auto a3 = a.columns[3].load();
+  mat4 m;
+  for (auto i = 0; i < 4; i++) {
+    const auto c = b.columns[i].load();
+    auto r = a0 * c.broadcast<0>();
+    r = madd(a1, c.broadcast<1>(), r);
+    r = madd(a2, c.broadcast<2>(), r);
+    r = madd(a3, c.broadcast<3>(), r);
+    m.columns[i] = vec4::store(r);
+  }
+  return m;
+}
+
+}  // namespace math
@@ -0,0 +1,259 @@
+#pragma once
+#include <algorithm>
+
+// Selects the SIMD instruction set. Define MATH_SCALAR to use the portable implementation.
+#if !defined(MATH_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATH_SSE 1
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define MATH_AVX 1
+#include <immintrin.h>
+#endif
+#elif !defined(MATH_SCALAR) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define MATH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace math {
+
+// Four packed floats in a SIMD register.
+class float4 {
+public:
+#if defined(MATH_SSE)
+  using native = __m128;
+#elif defined(MATH_NEON)
+  using native = float32x4_t;
+#else
+  struct native {
+    float v[4];
+  };
+#endif
+
+  float4() noexcept = default;
+  float4(native value) noexcept : value_(value) {}
+
+  float4(float x, float y, float z, float w) noexcept {
+#if defined(MATH_SSE)
+    value_ = _mm_set_ps(w, z, y, x);
+#elif defined(MATH_NEON)
+    const float values[4] = { x, y, z, w };
+    value_ = vld1q_f32(values);
+#else
+    value_ = { { x, y, z, w } };
+#endif
+  }
+
+  static float4 splat(float value) noexcept {
+#if defined(MATH_SSE)
+    return _mm_set1_ps(value);
+#elif defined(MATH_NEON)
+    return vdupq_n_f32(value);
+#else
+    return native{ { value, value, value, value } };
+#endif
+  }
+
+  // Loads four floats from 16 byte aligned memory.
+  static float4 load(const float* data) noexcept {
+#if defined(MATH_SSE)
+    return _mm_load_ps(data);
+#elif defined(MATH_NEON)
+    return vld1q_f32(data);
+#else
+    return native{ { data[0], data[1], data[2], data[3] } };
+#endif
+  }
+
+  // Loads four floats from unaligned memory.
+  static float4 loadu(const float* data) noexcept {
+#if defined(MATH_SSE)
+    return _mm_loadu_ps(data);
+#else
+    return load(data);
+#endif
+  }
+
+  void store(float* data) const noexcept {
+#if defined(MATH_SSE)
+    _mm_storeu_ps(data, value_);
+#elif defined(MATH_NEON)
+    vst1q_f32(data, value_);
+#else
+    for (auto i = 0; i < 4; i++) {
+      data[i] = value_.v[i];
+    }
+#endif
+  }
+
+  // Returns the lane broadcast to all lanes.
+  template <int Lane>
+  float4 broadcast() const noexcept {
+#if defined(MATH_SSE)
+    return _mm_shuffle_ps(value_, value_, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+#elif defined(MATH_NEON)
+    return vdupq_n_f32(vgetq_lane_f32(value_, Lane));
+#else
+    return splat(value_.v[Lane]);
+#endif
+  }
+
+  template <int Lane>
+  float get() const noexcept {
+#if defined(MATH_SSE)
+    return _mm_cvtss_f32(broadcast<Lane>());
+#elif defined(MATH_NEON)
+    return vgetq_lane_f32(value_, Lane);
+#else
+    return value_.v[Lane];
+#endif
+  }
+
+  friend float4 operator+(float4 a, float4 b) noexcept {
+#if defined(MATH_SSE)
+    return _mm_add_ps(a.value_, b.value_);
+#elif defined(MATH_NEON)
+    return vaddq_f32(a.value_, b.value_);
+#else
+    return native{ { a.value_.v[0] + b.value_.v[0], a.value_.v[1] + b.value_.v[1], a.value_.v[2] + b.value_.v[2],
+      a.value_.v[3] + b.value_.v[3] } };
+#endif
+  }
+
+  friend float4 operator-(float4 a, float4 b) noexcept {
+#if defined(MATH_SSE)
+    return _mm_sub_ps(a.value_, b.value_);
+#elif defined(MATH_NEON)
+    return vsubq_f32(a.value_, b.value_);
+#else
+    return native{ { a.value_.v[0] - b.value_.v[0], a.value_.v[1] - b.value_.v[1], a.value_.v[2] - b.value_.v[2],
+      a.value_.v[3] - b.value_.v[3] } };
+#endif
+  }
+
+  friend float4 operator*(float4 a, float4 b) noexcept {
+#if defined(MATH_SSE)
+    return _mm_mul_ps(a.value_, b.value_);
+#elif defined(MATH_NEON)
+    return vmulq_f32(a.value_, b.value_);
+#else
+    return native{ { a.value_.v[0] * b.value_.v[0], a.value_.v[1] * b.value_.v[1], a.value_.v[2] * b.value_.v[2],
+      a.value_.v[3] * b.value_.v[3] } };
+#endif
+  }
+
+  // Returns a * b + c.
+  friend float4 madd(float4 a, float4 b, float4 c) noexcept {
+#if defined(MATH_NEON)
+    return vmlaq_f32(c.value_, a.value_, b.value_);
+#else
+    return a * b + c;
+#endif
+  }
+
+  friend float4 min(float4 a, float4 b) noexcept {
+#if defined(MATH_SSE)
+    return _mm_min_ps(a.value_, b.value_);
+#elif defined(MATH_NEON)
+    return vminq_f32(a.value_, b.value_);
+#else
+    return native{ { std::min(a.value_.v[0], b.value_.v[0]), std::min(a.value_.v[1], b.value_.v[1]),
+      std::min(a.value_.v[2], b.value_.v[2]), std::min(a.value_.v[3], b.value_.v[3]) } };
+#endif
+  }
+
+  // Returns a bit mask of the lanes that are negative.
+  friend int negative(float4 a) noexcept {
+#if defined(MATH_SSE)
+    return _mm_movemask_ps(_mm_cmplt_ps(a.value_, _mm_setzero_ps()));
+#elif defined(MATH_NEON)
+    const auto mask = vcltq_f32(a.value_, vdupq_n_f32(0.0f));
+    return static_cast<int>((vgetq_lane_u32(mask, 0) & 1) | (vgetq_lane_u32(mask, 1) & 2) |
+      (vgetq_lane_u32(mask, 2) & 4) | (vgetq_lane_u32(mask, 3) & 8));
+#else
+    return (a.value_.v[0] < 0.0f ? 1 : 0) | (a.value_.v[1] < 0.0f ? 2 : 0) | (a.value_.v[2] < 0.0f ? 4 : 0) |
+      (a.value_.v[3] < 0.0f ? 8 : 0);
+#endif
+  }
+
+  // Transposes the 4x4 matrix with the rows a, b, c and d.
+  friend void transpose(float4& a, float4& b, float4& c, float4& d) noexcept {
+#if defined(MATH_SSE)
+    _MM_TRANSPOSE4_PS(a.value_, b.value_, c.value_, d.value_);
+#elif defined(MATH_NEON)
+    const auto ab = vtrnq_f32(a.value_, b.value_);
+    const auto cd = vtrnq_f32(c.value_, d.value_);
+    a.value_ = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b.value_ = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c.value_ = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d.value_ = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+#else
+    float m[4][4];
+    a.store(m[0]);
+    b.store(m[1]);
+    c.store(m[2]);
+    d.store(m[3]);
+    a = float4(m[0][0], m[1][0], m[2][0], m[3][0]);
+    b = float4(m[0][1], m[1][1], m[2][1], m[3][1]);
+    c = float4(m[0][2], m[1][2], m[2][2], m[3][2]);
+    d = float4(m[0][3], m[1][3], m[2][3], m[3][3]);
+#endif
+  }
+
+  operator native() const noexcept {
+    return value_;
+  }
+
+private:
+  native value_;
+};
+
+#if defined(MATH_AVX)
+// Eight packed floats in an AVX register.
+class float8 {
+public:
+  float8() noexcept = default;
+  float8(__m256 value) noexcept : value_(value) {}
+
+  static float8 splat(float value) noexcept {
+    return _mm256_set1_ps(value);
+  }
+
+  static float8 loadu(const float* data) noexcept {
+    return _mm256_loadu_ps(data);
+  }
+
+  friend float8 operator+(float8 a, float8 b) noexcept {
+    return _mm256_add_ps(a.value_, b.value_);
+  }
+
+  friend float8 operator-(float8 a, float8 b) noexcept {
+    return _mm256_sub_ps(a.value_, b.value_);
+  }
+
+  friend float8 operator*(float8 a, float8 b) noexcept {
+    return _mm256_mul_ps(a.value_, b.value_);
+  }
+
+  friend float8 min(float8 a, float8 b) noexcept {
+    return _mm256_min_ps(a.value_, b.value_);
+  }
+
+  // Returns a bit mask of the lanes that are negative.
+  friend int negative(float8 a) noexcept {
+    return _mm256_movemask_ps(_mm256_cmp_ps(a.value_, _mm256_setzero_ps(), _CMP_LT_OQ));
+  }
+
+  float4 low() const noexcept {
+    return _mm256_castps256_ps128(value_);
+  }
+
+  float4 high() const noexcept {
+    return _mm256_extractf128_ps(value_, 1);
+  }
+
+private:
+  __m256 value_;
+};
+#endif
+
+}  // namespace math
@@ -0,0 +1,86 @@
+#include "options.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+options::options(int argc, char* argv[]) {
+  for (auto i = 1; i < argc; ++i) {
+    const std::string_view arg(argv[i]);
+    const auto pos = arg.find('=');
+    const auto key = arg.substr(0, pos);
+    const auto value = pos == std::string_view::npos ? std::string_view() : arg.substr(pos + 1);
+    if (key == "--frames") {
+      frames = std::strtoull(value.data(), nullptr, 10);
+    } else if (key == "--size") {
+      int x = 0;
+      int y = 0;
+      if (std::sscanf(value.data(), "%dx%d", &x, &y) == 2) {
+        cx = static_cast<GLsizei>(std::max(1, x));
+        cy = static_cast<GLsizei>(std::max(1, y));
+      }
+    } else if (key == "--resize") {
+      for (std::size_t begin = 0; begin < value.size();) {
+        auto end = value.find(',', begin);
+        if (end == std::string_view::npos) {
+          end = value.size();
+        }
+        const std::string step(value.substr(begin, end - begin));
+        unsigned long long frame = 0;
+        int x = 0;
+        int y = 0;
+        if (std::sscanf(step.data(), "%llu:%dx%d", &frame, &x, &y) == 3) {
+          resize.push_back({ frame, static_cast<GLsizei>(std::max(1, x)), static_cast<GLsizei>(std::max(1, y)) });
+        }
+        begin = end + 1;
+      }
+      std::stable_sort(resize.begin(), resize.end(), [](const resize_step& a, const resize_step& b) {
+        return a.frame < b.frame;
+      });
+    } else if (key == "--pacing") {
+      if (value == "vsync") {
+        pacing = ::pacing::vsync;
+      } else if (value == "uncapped") {
+        pacing = ::pacing::uncapped;
+      } else if (value == "fps") {
+        pacing = ::pacing::fixed;
+      }
+    } else if (key == "--fps") {
+      pacing = ::pacing::fixed;
+      fps = std::max(1, std::atoi(value.data()));
+    } else if (key == "--backend") {
+      backend = value;
+    } else if (key == "--present") {
+      present_fast = value != "copy";
+    } else if (key == "--frames-in-flight") {
+      frames_in_flight = static_cast<std::size_t>(std::max(1, std::atoi(value.data())));
+    } else if (key == "--samples") {
+      samples = static_cast<GLsizei>(std::max(0, std::atoi(value.data())));
+    } else if (key == "--dynamic-resolution") {
+      dynamic_resolution = value.empty() ? -1.0f : std::max(0.1f, std::strtof(value.data(), nullptr));
+    } else if (key == "--profile") {
+      profile = true;
+    } else if (key == "--capture") {
+      capture = value;
+    } else if (key == "--capture-format") {
+      capture_raw = value == "raw";
+    } else if (key == "--shader-cache") {
+      shader_cache = value;
+    } else if (key == "--gl-errors") {
+      if (value == "none") {
+        gl_errors = gl::error_policy::none;
+      } else if (value == "frame") {
+        gl_errors = gl::error_policy::frame;
+      } else if (value == "call") {
+        gl_errors = gl::error_policy::call;
+      }
+    } else if (key == "--gl-debug") {
+      gl_debug = true;
+      gl_debug_sync = value == "sync";
+    }
+  }
+  if (dynamic_resolution < 0.0f) {
+    dynamic_resolution = 1000.0f / static_cast<float>(fps);
+  }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <gl/error.h>
+#include <GLES3/gl3.h>
+#include <string>
+#include <vector>
+
+// Frame pacing mode of the render loop.
+enum class pacing {
+  vsync,     // Wait for the vertical blank in eglSwapBuffers.
+  uncapped,  // Render as fast as possible.
+  fixed,     // Render at a fixed target frame rate.
+};
+
+// Client size change scheduled before a frame.
+struct resize_step {
+  unsigned long long frame = 0;
+  GLsizei cx = 0;
+  GLsizei cy = 0;
+};
+
+// Command line options.
+//
+// --frames=N                   stop after N frames (headless only, 0 renders until interrupted)
+// --size=WxH                   initial client size
+// --resize=N:WxH[,N:WxH...]    resize the client before frame N (headless only)
+// --pacing=vsync|uncapped|fps  frame pacing mode
+// --fps=N                      target frame rate for fixed pacing (implies --pacing=fps)
+// --backend=LIST               comma separated backend fallback chain: d3d11, vulkan, gl, gles and swiftshader
+//                              (ANGLE), surfaceless (Mesa) and default (eglGetDisplay)
+// --present=fast|copy          D3D11 present path (fast falls back to copy when no config matches)
+// --frames-in-flight=N         number of frames the CPU may run ahead of the GPU (default 2)
+// --samples=N                  multisample count (limited by GL_MAX_SAMPLES, 0 or 1 disables multisampling)
+// --dynamic-resolution[=MS]    scale the scene resolution to meet a frame time budget (defaults to 1000/fps)
+// --profile                    print frame timing statistics on exit
+// --capture=DIR                write rendered frames to DIR without stalling the render loop
+// --capture-format=png|raw     image format of captured frames
+// --shader-cache=DIR           store linked program binaries in DIR
+// --gl-errors=none|frame|call  error checking policy (limited by GL_ERROR_POLICY)
+// --gl-debug[=sync]            report errors through a KHR_debug message callback
+struct options {
+  options() noexcept = default;
+  options(int argc, char* argv[]);
+
+  unsigned long long frames = 0;
+  GLsizei cx = 800;
+  GLsizei cy = 600;
+
+  // Resize schedule ordered by frame.
+  std::vector<resize_step> resize;
+
+  ::pacing pacing = ::pacing::vsync;
+  int fps = 60;
+
+  // Backend fallback chain or empty for the platform default.
+  std::string backend;
+  bool present_fast = true;
+
+  std::size_t frames_in_flight = 2;
+
+  GLsizei samples = 4;
+
+  // Frame time budget in milliseconds for dynamic resolution scaling or 0 when disabled.
+  float dynamic_resolution = 0.0f;
+
+  bool profile = false;
+
+  // Directory for captured frames or empty when disabled. Frames are written as raw RGBA8 pixels when
+  // capture_raw is set and as PNG images otherwise.
+  std::string capture;
+  bool capture_raw = false;
+
+  std::string shader_cache;
+
+  gl::error_policy gl_errors = static_cast<gl::error_policy>(GL_ERROR_POLICY);
+  bool gl_debug = false;
+  bool gl_debug_sync = false;
+};
@@ -0,0 +1,250 @@
+#include "profiler.h"
+#include <gl/extensions.h>
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+PFNGLQUERYCOUNTEREXTPROC glQueryCounter = nullptr;
+PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64v = nullptr;
+
+float milliseconds(profiler::clock::duration duration) noexcept {
+  return std::chrono::duration<float, std::milli>(duration).count();
+}
+
+profiler::statistics analyze(std::vector<float>& values) {
+  profiler::statistics stats;
+  values.erase(std::remove_if(values.begin(), values.end(), [](float value) { return value < 0.0f; }), values.end());
+  if (values.empty()) {
+    return stats;
+  }
+  std::sort(values.begin(), values.end());
+  stats.count = values.size();
+  stats.min = values.front();
+  for (const auto value : values) {
+    stats.avg += value;
+  }
+  stats.avg /= static_cast<float>(values.size());
+  const auto p99 = static_cast<std::size_t>(std::ceil(values.size() * 0.99)) - 1;
+  stats.p99 = values[std::min(p99, values.size() - 1)];
+  return stats;
+}
+
+}  // namespace
+
+profiler::scope::scope(profiler& profiler, stage stage) noexcept : profiler_(profiler), stage_(stage), start_(clock::now()) {
+  if (profiler_.gpu_) {
+    const auto index = static_cast<std::size_t>(stage_);
+    auto& pending = profiler_.pending_[profiler_.frame_ % latency];
+    if (profiler_.timestamps_) {
+      glQueryCounter(pending.queries[index * 2], GL_TIMESTAMP_EXT);
+    } else {
+      glBeginQuery(GL_TIME_ELAPSED_EXT, pending.queries[index * 2]);
+    }
+  }
+}
+
+profiler::scope::~scope() {
+  const auto index = static_cast<std::size_t>(stage_);
+  auto& pending = profiler_.pending_[profiler_.frame_ % latency];
+  pending.data.cpu[index] = milliseconds(clock::now() - start_);
+  if (profiler_.gpu_) {
+    if (profiler_.timestamps_) {
+      glQueryCounter(pending.queries[index * 2 + 1], GL_TIMESTAMP_EXT);
+    } else {
+      glEndQuery(GL_TIME_ELAPSED_EXT);
+    }
+    pending.measured |= 1U << index;
+  }
+}
+
+void profiler::create() {
+  gpu_ = false;
+  timestamps_ = false;
+  if (gl::extension("GL_EXT_disjoint_timer_query")) {
+    glQueryCounter = gl::proc<PFNGLQUERYCOUNTEREXTPROC>("glQueryCounterEXT");
+    glGetQueryObjectui64v = gl::proc<PFNGLGETQUERYOBJECTUI64VEXTPROC>("glGetQueryObjectui64vEXT");
+    gpu_ = glGetQueryObjectui64v != nullptr;
+  }
+  if (gpu_) {
+    // Prefer timestamps, but some implementations only support elapsed time queries.
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &bits);
+    timestamps_ = glQueryCounter && glGetError() == GL_NO_ERROR && bits > 0;
+    for (auto& pending : pending_) {
+      glGenQueries(static_cast<GLsizei>(pending.queries.size()), pending.queries.data());
+    }
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+  }
+}
+
+void profiler::destroy() noexcept {
+  if (gpu_) {
+    for (auto& pending : pending_) {
+      glDeleteQueries(static_cast<GLsizei>(pending.queries.size()), pending.queries.data());
+      pending = {};
+    }
+  }
+  gpu_ = false;
+}
+
+void profiler::begin() noexcept {
+  // Publish the frame that used this set of queries before.
+  auto& pending = pending_[frame_ % latency];
+  if (pending.measured) {
+    collect(pending);
+  }
+  pending.data = {};
+  pending.data.frame = frame_;
+  pending.data.cpu.fill(-1.0f);
+  pending.data.gpu.fill(-1.0f);
+  pending.measured = 0;
+  start_ = clock::now();
+}
+
+void profiler::end() noexcept {
+  auto& pending = pending_[frame_ % latency];
+  pending.data.total = milliseconds(clock::now() - start_);
+  if (!pending.measured) {
+    publish(pending.data);
+  }
+  frame_++;
+}
+
+std::vector<profiler::record> profiler::records() const {
+  const auto published = published_.load(std::memory_order_acquire);
+  const auto count = std::min<std::uint64_t>(published, history);
+  std::vector<record> records;
+  records.reserve(static_cast<std::size_t>(count));
+  for (auto i = published - count; i < published; i++) {
+    records.push_back(read(slots_[i % history]));
+  }
+  return records;
+}
+
+bool profiler::latest(record& record) const noexcept {
+  const auto published = published_.load(std::memory_order_acquire);
+  if (!published) {
+    return false;
+  }
+  record = read(slots_[(published - 1) % history]);
+  return true;
+}
+
+profiler::summary profiler::report() const {
+  const auto records = this->records();
+  std::vector<float> values;
+  values.reserve(records.size());
+  summary summary;
+  for (std::size_t i = 0; i < stages; i++) {
+    values.clear();
+    for (const auto& record : records) {
+      values.push_back(record.cpu[i]);
+    }
+    summary.cpu[i] = analyze(values);
+    values.clear();
+    for (const auto& record : records) {
+      values.push_back(record.gpu[i]);
+    }
+    summary.gpu[i] = analyze(values);
+  }
+  values.clear();
+  for (const auto& record : records) {
+    values.push_back(record.total);
+  }
+  summary.total = analyze(values);
+  return summary;
+}
+
+void profiler::print(std::FILE* file) const {
+  const auto summary = report();
+  const auto line = [file](const char* name, const char* type, const statistics& stats) {
+    if (stats.count) {
+      std::fprintf(file, "%-8s %s min %7.3f ms  avg %7.3f ms  p99 %7.3f ms  (%zu frames)\n",
+        name, type, stats.min, stats.avg, stats.p99, stats.count);
+    }
+  };
+  for (std::size_t i = 0; i < stages; i++) {
+    line(name(static_cast<stage>(i)), "cpu", summary.cpu[i]);
+    line(name(static_cast<stage>(i)), "gpu", summary.gpu[i]);
+  }
+  line("frame", "cpu", summary.total);
+}
+
+const char* profiler::name(stage stage) noexcept {
+  switch (stage) {
+  case stage::render: return "render";
+  case stage::resolve: return "resolve";
+  case stage::capture: return "capture";
+  case stage::present: return "present";
+  }
+  return "unknown";
+}
+
+profiler::record profiler::read(const slot& slot) noexcept {
+  record record;
+  while (true) {
+    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence & 1) {
+      continue;
+    }
+    record.frame = slot.frame.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < stages; i++) {
+      record.cpu[i] = slot.cpu[i].load(std::memory_order_relaxed);
+      record.gpu[i] = slot.gpu[i].load(std::memory_order_relaxed);
+    }
+    record.total = slot.total.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+      return record;
+    }
+  }
+}
+
+void profiler::collect(pending& pending) noexcept {
+  // Discard the results when the GPU counters were disjoint (e.g. frequency change) or are not ready yet.
+  // Querying the disjoint state also resets it.
+  GLint disjoint = 0;
+  glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+  GLuint last = 0;
+  for (std::size_t i = 0; i < stages; i++) {
+    if (pending.measured & (1U << i)) {
+      last = pending.queries[i * 2 + (timestamps_ ? 1 : 0)];
+    }
+  }
+  GLuint available = GL_FALSE;
+  glGetQueryObjectuiv(last, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!disjoint && available) {
+    for (std::size_t i = 0; i < stages; i++) {
+      if (pending.measured & (1U << i)) {
+        GLuint64 beg = 0;
+        GLuint64 end = 0;
+        if (timestamps_) {
+          glGetQueryObjectui64v(pending.queries[i * 2], GL_QUERY_RESULT, &beg);
+        }
+        glGetQueryObjectui64v(pending.queries[i * 2 + (timestamps_ ? 1 : 0)], GL_QUERY_RESULT, &end);
+        pending.data.gpu[i] = static_cast<float>(static_cast<double>(end - beg) / 1.0e6);
+      }
+    }
+  }
+  publish(pending.data);
+  pending.measured = 0;
+}
+
+void profiler::publish(const record& record) noexcept {
+  const auto published = published_.load(std::memory_order_relaxed);
+  auto& slot = slots_[published % history];
+  const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.frame.store(record.frame, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < stages; i++) {
+    slot.cpu[i].store(record.cpu[i], std::memory_order_relaxed);
+    slot.gpu[i].store(record.gpu[i], std::memory_order_relaxed);
+  }
+  slot.total.store(record.total, std::memory_order_relaxed);
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+  published_.store(published + 1, std::memory_order_release);
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <GLES3/gl3.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Collects per-stage CPU and GPU frame timings.
+// GPU timings use EXT_disjoint_timer_query when available and are read back a few frames later.
+// Completed frames are published into a lock-free ring that can be queried from any thread.
+class profiler {
+public:
+  using clock = std::chrono::steady_clock;
+
+  enum class stage : std::size_t {
+    render,
+    resolve,
+    capture,
+    present,
+  };
+
+  // Number of stages.
+  static constexpr std::size_t stages = 4;
+
+  // Number of frames kept in the history ring.
+  static constexpr std::size_t history = 256;
+
+  // Number of frames GPU queries stay in flight before their results are read.
+  static constexpr std::size_t latency = 4;
+
+  // Frame timings in milliseconds. Stage timings are negative when the stage did not run in the frame and
+  // GPU timings are also negative when unavailable.
+  struct record {
+    std::uint64_t frame = 0;
+    std::array<float, stages> cpu = {};
+    std::array<float, stages> gpu = {};
+    float total = 0.0f;
+  };
+
+  // Statistics over the frames that measured a value. The count is 0 when none did.
+  struct statistics {
+    std::size_t count = 0;
+    float min = 0.0f;
+    float avg = 0.0f;
+    float p99 = 0.0f;
+  };
+
+  struct summary {
+    std::array<statistics, stages> cpu;
+    std::array<statistics, stages> gpu;
+    statistics total;
+  };
+
+  // Measures the CPU time and, when supported, the GPU time of a stage.
+  class scope {
+  public:
+    scope(profiler& profiler, stage stage) noexcept;
+    scope(scope&& other) = delete;
+    scope& operator=(scope&& other) = delete;
+    ~scope();
+
+  private:
+    profiler& profiler_;
+    stage stage_;
+    clock::time_point start_;
+  };
+
+  profiler() noexcept = default;
+  profiler(profiler&& other) = delete;
+  profiler& operator=(profiler&& other) = delete;
+
+  // Must be called with a current context.
+  void create();
+  void destroy() noexcept;
+
+  void begin() noexcept;
+  void end() noexcept;
+
+  bool gpu() const noexcept {
+    return gpu_;
+  }
+
+  // Returns the published frame records from oldest to newest. Thread-safe.
+  std::vector<record> records() const;
+
+  // Returns the newest published frame record or false when no frame was published yet. Thread-safe.
+  bool latest(record& record) const noexcept;
+
+  // Returns statistics over the published frame records. Thread-safe.
+  summary report() const;
+
+  // Writes the report in a human readable format. Thread-safe.
+  void print(std::FILE* file) const;
+
+  static const char* name(stage stage) noexcept;
+
+private:
+  struct pending {
+    record data;
+    std::array<GLuint, stages * 2> queries = {};
+    unsigned measured = 0;
+  };
+
+  struct slot {
+    std::atomic<std::uint64_t> sequence = 0;
+    std::atomic<std::uint64_t> frame = 0;
+    std::array<std::atomic<float>, stages> cpu = {};
+    std::array<std::atomic<float>, stages> gpu = {};
+    std::atomic<float> total = 0.0f;
+  };
+
+  static record read(const slot& slot) noexcept;
+  void collect(pending& pending) noexcept;
+  void publish(const record& record) noexcept;
+
+  bool gpu_ = false;
+  bool timestamps_ = false;
+
+  std::uint64_t frame_ = 0;
+  clock::time_point start_;
+  std::array<pending, latency> pending_ = {};
+
+  std::array<slot, history> slots_;
+  std::atomic<std::uint64_t> published_ = 0;
+};
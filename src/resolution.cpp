@@ -0,0 +1,32 @@
+#include "resolution.h"
+#include <algorithm>
+#include <cmath>
+
+resolution::resolution(float budget, float min, float max) noexcept :
+  budget_(budget), min_(min), max_(max), scale_(max) {}
+
+float resolution::update(float time) noexcept {
+  // Smooth out single frame spikes.
+  average_ = average_ > 0.0f ? average_ + (time - average_) * 0.1f : time;
+  if (cooldown_ > 0) {
+    cooldown_--;
+    return scale_;
+  }
+
+  // Drop quickly when over budget and grow one step at a time when there is enough headroom.
+  auto scale = scale_;
+  const auto load = average_ / budget_;
+  if (load > 1.0f) {
+    scale = std::floor(scale_ / std::sqrt(load) / step) * step;
+  } else if (load < 0.75f) {
+    scale = scale_ + step;
+  }
+  scale = std::clamp(scale, min_, max_);
+  if (scale != scale_) {
+    // Predict the frame time at the new scale until new measurements arrive.
+    average_ *= (scale * scale) / (scale_ * scale_);
+    scale_ = scale;
+    cooldown_ = cooldown;
+  }
+  return scale_;
+}
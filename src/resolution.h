@@ -0,0 +1,34 @@
+#pragma once
+
+// Adjusts the render scale from measured frame times towards a frame time budget.
+// The GPU cost of a frame is assumed to grow with the number of pixels, i.e. with the square of the scale.
+// Scales are quantized to steps, so that render targets of previous sizes can be reused from the pool.
+class resolution {
+public:
+  // Scale quantization step.
+  static constexpr float step = 1.0f / 16.0f;
+
+  // Number of frames to wait after a change before the next one, so that delayed GPU timings catch up.
+  static constexpr int cooldown = 8;
+
+  resolution(float budget, float min = 0.5f, float max = 1.0f) noexcept;
+
+  // Updates the scale with the frame time of a completed frame in milliseconds.
+  float update(float time) noexcept;
+
+  float scale() const noexcept {
+    return scale_;
+  }
+
+  float budget() const noexcept {
+    return budget_;
+  }
+
+private:
+  float budget_ = 0.0f;
+  float min_ = 0.5f;
+  float max_ = 1.0f;
+  float scale_ = 1.0f;
+  float average_ = 0.0f;
+  int cooldown_ = 0;
+};
@@ -0,0 +1,31 @@
+#include "scheduler.h"
+#include <algorithm>
+#include <thread>
+
+scheduler::scheduler(::pacing pacing, int fps) noexcept :
+  pacing_(pacing), period_(std::chrono::duration_cast<clock::duration>(std::chrono::seconds(1)) / std::max(1, fps)),
+  next_(clock::now()) {}
+
+void scheduler::wait() noexcept {
+  frame_++;
+  if (pacing_ != ::pacing::fixed) {
+    return;
+  }
+
+  // Skip missed deadlines instead of rendering a burst of frames to catch up.
+  const auto now = clock::now();
+  next_ += period_;
+  if (next_ < now) {
+    next_ = now;
+    return;
+  }
+
+  // Sleep for most of the remaining time and yield for the rest, since sleep granularity can be a millisecond or worse.
+  const auto spin = std::chrono::milliseconds(1);
+  if (next_ - now > spin) {
+    std::this_thread::sleep_until(next_ - spin);
+  }
+  while (clock::now() < next_) {
+    std::this_thread::yield();
+  }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <options.h>
+#include <chrono>
+
+// Paces the render loop according to the selected mode.
+// Vertical sync is handled by eglSwapBuffers and uncapped frames are not delayed at all.
+class scheduler {
+public:
+  using clock = std::chrono::steady_clock;
+
+  scheduler(::pacing pacing, int fps) noexcept;
+
+  // Blocks until the next frame is due.
+  void wait() noexcept;
+
+  // Returns the number of frames rendered since construction.
+  unsigned long long frame() const noexcept {
+    return frame_;
+  }
+
+private:
+  ::pacing pacing_ = ::pacing::vsync;
+  clock::duration period_ = {};
+  clock::time_point next_ = {};
+  unsigned long long frame_ = 0;
+};
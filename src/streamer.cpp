@@ -0,0 +1,296 @@
+#include "streamer.h"
+#include <egl/error.h>
+#include <gl/error.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+streamer::streamer(EGLDisplay display, EGLConfig config, EGLContext share, std::size_t workers, std::size_t buffers) :
+  display_(display), decoder_(read_ppm), buffers_(std::max<std::size_t>(buffers, 1)) {
+  // Prefer a surfaceless context and fall back to a minimal pbuffer.
+  const auto extensions = eglQueryString(display_, EGL_EXTENSIONS);
+  if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context")) {
+    const EGLint attributes[] = {
+      EGL_WIDTH, 1,
+      EGL_HEIGHT, 1,
+      EGL_NONE,
+    };
+    surface_ = eglCreatePbufferSurface(display_, config, attributes);
+    if (surface_ == EGL_NO_SURFACE) {
+      throw egl::system_error(egl::error(), "Could not create OpenGL ES upload surface");
+    }
+  }
+  const EGLint ctxattr[] = {
+    EGL_CONTEXT_CLIENT_VERSION, 3,
+    EGL_NONE
+  };
+  context_ = eglCreateContext(display_, config, share, ctxattr);
+  if (context_ == EGL_NO_CONTEXT) {
+    const auto ec = egl::error();
+    if (surface_ != EGL_NO_SURFACE) {
+      eglDestroySurface(display_, surface_);
+    }
+    throw egl::system_error(ec, "Could not create OpenGL ES upload context");
+  }
+  uploader_ = std::thread([this]() { upload(); });
+  for (std::size_t i = 0; i < std::max<std::size_t>(workers, 1); i++) {
+    workers_.emplace_back([this]() { decode(); });
+  }
+}
+
+streamer::~streamer() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  decode_cv_.notify_all();
+  upload_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  uploader_.join();
+
+  // Textures and fences are shared with the render context, which is current on the calling thread.
+  complete_.clear();
+  upload_.clear();
+  decode_.clear();
+  eglDestroyContext(display_, context_);
+  if (surface_ != EGL_NO_SURFACE) {
+    eglDestroySurface(display_, surface_);
+  }
+}
+
+std::shared_ptr<const streamer::texture> streamer::load(std::filesystem::path path) {
+  auto texture = std::make_shared<streamer::texture>();
+  texture->path_ = std::move(path);
+  {
+    std::lock_guard lock(mutex_);
+    pending_++;
+    if (!error_.empty()) {
+      item item;
+      item.texture = texture;
+      item.error = error_;
+      complete_.push_back(std::move(item));
+      return texture;
+    }
+    decode_.push_back(texture);
+  }
+  decode_cv_.notify_one();
+  return texture;
+}
+
+std::size_t streamer::update() {
+  std::lock_guard lock(mutex_);
+  const auto size = complete_.size();
+  complete_.erase(std::remove_if(complete_.begin(), complete_.end(), [](item& item) {
+    auto& texture = *item.texture;
+    if (!item.error.empty()) {
+      texture.error_ = std::move(item.error);
+      return true;
+    }
+    if (!item.fence.signaled()) {
+      return false;
+    }
+    texture.texture_ = std::move(item.name);
+    texture.cx_ = item.image.cx;
+    texture.cy_ = item.image.cy;
+    texture.ready_ = true;
+    return true;
+  }), complete_.end());
+  const auto published = size - complete_.size();
+  pending_ -= published;
+  return published;
+}
+
+std::size_t streamer::pending() const noexcept {
+  std::lock_guard lock(mutex_);
+  return pending_;
+}
+
+std::string streamer::error() const {
+  std::lock_guard lock(mutex_);
+  return error_;
+}
+
+void streamer::set_decoder(decoder decoder) {
+  std::lock_guard lock(mutex_);
+  decoder_ = std::move(decoder);
+}
+
+streamer::image streamer::read_ppm(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw gl::runtime_error("Could not open image: " + path.string());
+  }
+  std::string magic;
+  int cx = 0;
+  int cy = 0;
+  int max = 0;
+  file >> magic >> cx >> cy >> max;
+  if (magic != "P6" || cx <= 0 || cy <= 0 || max != 255 || !file.get()) {
+    throw gl::runtime_error("Unsupported image format: " + path.string());
+  }
+  const auto pixels = static_cast<std::size_t>(cx) * static_cast<std::size_t>(cy);
+  std::vector<std::uint8_t> rgb(pixels * 3);
+  if (!file.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()))) {
+    throw gl::runtime_error("Could not read image: " + path.string());
+  }
+  image image;
+  image.cx = cx;
+  image.cy = cy;
+  image.data.resize(pixels * 4);
+  for (std::size_t i = 0; i < pixels; i++) {
+    std::memcpy(&image.data[i * 4], &rgb[i * 3], 3);
+    image.data[i * 4 + 3] = 0xFF;
+  }
+  return image;
+}
+
+void streamer::decode() {
+  while (true) {
+    std::shared_ptr<texture> texture;
+    decoder decoder;
+    {
+      std::unique_lock lock(mutex_);
+      decode_cv_.wait(lock, [this]() { return stopping_ || !decode_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      texture = std::move(decode_.front());
+      decode_.pop_front();
+      decoder = decoder_;
+    }
+    item item;
+    item.texture = std::move(texture);
+    try {
+      item.image = decoder(item.texture->path_);
+    }
+    catch (const std::exception& e) {
+      item.error = e.what();
+    }
+    {
+      std::lock_guard lock(mutex_);
+      if (!error_.empty() && item.error.empty()) {
+        item.error = error_;
+      }
+      if (!item.error.empty()) {
+        complete_.push_back(std::move(item));
+        continue;
+      }
+      upload_.push_back(std::move(item));
+    }
+    upload_cv_.notify_one();
+  }
+}
+
+void streamer::upload() {
+  if (!eglMakeCurrent(display_, surface_, surface_, context_)) {
+    fail(egl::system_error(egl::error(), "Could not make OpenGL ES upload context current").what());
+    return;
+  }
+  std::vector<buffer> buffers(buffers_);
+  std::size_t next = 0;
+  while (true) {
+    item item;
+    {
+      std::unique_lock lock(mutex_);
+      upload_cv_.wait(lock, [this]() { return stopping_ || !upload_.empty(); });
+      if (stopping_) {
+        break;
+      }
+      item = std::move(upload_.front());
+      upload_.pop_front();
+    }
+    try {
+      upload(item, buffers[next]);
+    }
+    catch (const std::exception& e) {
+      item.error = e.what();
+      item.name = {};
+      item.fence = {};
+    }
+    next = (next + 1) % buffers.size();
+    item.image.data = {};
+    std::lock_guard lock(mutex_);
+    complete_.push_back(std::move(item));
+  }
+  for (auto& buffer : buffers) {
+    buffer.fence = {};
+    if (buffer.handle) {
+      glDeleteBuffers(1, &buffer.handle);
+    }
+  }
+  glFinish();
+  eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  eglReleaseThread();
+}
+
+void streamer::upload(item& item, buffer& buffer) {
+  const auto& image = item.image;
+  const auto size = static_cast<GLsizeiptr>(image.data.size());
+
+  // Wait until the previous upload from this buffer was consumed.
+  if (buffer.fence) {
+    buffer.fence.wait();
+    buffer.fence = {};
+  }
+  if (!buffer.handle) {
+    glGenBuffers(1, &buffer.handle);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.handle);
+  if (buffer.capacity < size) {
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    buffer.capacity = size;
+  }
+  const auto access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+  const auto data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, access);
+  if (!data) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    throw gl::system_error(gl::error(), "Could not map pixel unpack buffer");
+  }
+  std::memcpy(data, image.data.data(), image.data.size());
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+  // Allocate immutable storage with a full mip chain and copy the pixels from the buffer.
+  auto levels = 1;
+  while ((std::max(image.cx, image.cy) >> levels) > 0) {
+    levels++;
+  }
+  item.name = gl::textures(1);
+  glBindTexture(GL_TEXTURE_2D, item.name[0]);
+  glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, image.cx, image.cy);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.cx, image.cy, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glGenerateMipmap(GL_TEXTURE_2D);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  if (const auto ec = gl::check()) {
+    throw gl::system_error(ec, "Could not upload texture");
+  }
+
+  // The render thread polls the texture fence, the buffer fence protects the buffer from being overwritten.
+  // Flush so that the fences become visible to the render context.
+  item.fence = gl::fence(GL_SYNC_GPU_COMMANDS_COMPLETE);
+  buffer.fence = gl::fence(GL_SYNC_GPU_COMMANDS_COMPLETE);
+  glFlush();
+}
+
+void streamer::fail(std::string error) {
+  // Fail the queued loads. Loads that are decoding and later loads fail with the same error.
+  std::lock_guard lock(mutex_);
+  error_ = std::move(error);
+  for (auto& texture : decode_) {
+    item item;
+    item.texture = std::move(texture);
+    item.error = error_;
+    complete_.push_back(std::move(item));
+  }
+  decode_.clear();
+  for (auto& item : upload_) {
+    item.error = error_;
+    complete_.push_back(std::move(item));
+  }
+  upload_.clear();
+}
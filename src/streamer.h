@@ -0,0 +1,144 @@
+#pragma once
+#include <gl/fence.h>
+#include <gl/textures.h>
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams textures in the background.
+//
+// Images are decoded on worker threads and uploaded by a dedicated thread with its own EGL context that shares
+// objects with the render context. Uploads go through a pool of pixel unpack buffers, so that the upload thread
+// never waits for the driver to copy client memory. Each finished texture is protected by a fence that is polled
+// by the render thread in update(), which publishes the texture once the upload completed on the GPU.
+class streamer {
+public:
+  // Decoded image with tightly packed RGBA8 pixels.
+  struct image {
+    GLsizei cx = 0;
+    GLsizei cy = 0;
+    std::vector<std::uint8_t> data;
+  };
+
+  // Decodes the image at the given path. Called on worker threads and throws on errors.
+  using decoder = std::function<image(const std::filesystem::path& path)>;
+
+  // Texture handle. The texture name is valid when ready() returns true.
+  // The handle is updated by update() and must only be read on the render thread.
+  class texture {
+  public:
+    bool ready() const noexcept {
+      return ready_;
+    }
+
+    bool failed() const noexcept {
+      return !error_.empty();
+    }
+
+    const std::string& error() const noexcept {
+      return error_;
+    }
+
+    GLuint name() const noexcept {
+      return ready_ ? texture_[0] : 0;
+    }
+
+    GLsizei cx() const noexcept {
+      return cx_;
+    }
+
+    GLsizei cy() const noexcept {
+      return cy_;
+    }
+
+  private:
+    friend class streamer;
+
+    std::filesystem::path path_;
+    gl::textures texture_;
+    GLsizei cx_ = 0;
+    GLsizei cy_ = 0;
+    std::string error_;
+    bool ready_ = false;
+  };
+
+  // Creates the upload context for the given display and configuration, sharing objects with the given context.
+  // Must be called on the render thread.
+  streamer(EGLDisplay display, EGLConfig config, EGLContext share, std::size_t workers = 2, std::size_t buffers = 4);
+
+  streamer(streamer&& other) = delete;
+  streamer& operator=(streamer&& other) = delete;
+
+  ~streamer();
+
+  // Queues an image for loading.
+  std::shared_ptr<const texture> load(std::filesystem::path path);
+
+  // Publishes textures whose uploads completed. Must be called on the render thread, usually once per frame.
+  // Returns the number of textures that became ready or failed.
+  std::size_t update();
+
+  // Number of textures that were queued, but not yet published.
+  std::size_t pending() const noexcept;
+
+  // Returns the error that stopped the upload thread or an empty string. All loads fail with this error.
+  std::string error() const;
+
+  // Replaces the decoder. The default decoder reads binary PPM (P6) images.
+  void set_decoder(decoder decoder);
+
+  // Reads a binary PPM (P6) image.
+  static image read_ppm(const std::filesystem::path& path);
+
+private:
+  // Pixel unpack buffer that is reused after its last upload completed.
+  struct buffer {
+    GLuint handle = 0;
+    GLsizeiptr capacity = 0;
+    gl::fence fence;
+  };
+
+  // Texture in flight. Results are staged here and copied to the texture by update() on the render thread.
+  struct item {
+    std::shared_ptr<streamer::texture> texture;
+    streamer::image image;
+    gl::textures name;
+    gl::fence fence;
+    std::string error;
+  };
+
+  void decode();
+  void upload();
+  void upload(item& item, buffer& buffer);
+  void fail(std::string error);
+
+  EGLDisplay display_ = EGL_NO_DISPLAY;
+  EGLSurface surface_ = EGL_NO_SURFACE;
+  EGLContext context_ = EGL_NO_CONTEXT;
+
+  mutable std::mutex mutex_;
+  std::condition_variable decode_cv_;
+  std::condition_variable upload_cv_;
+  decoder decoder_;
+  bool stopping_ = false;
+  std::size_t pending_ = 0;
+  std::string error_;
+
+  // Textures waiting for decode, decoded images waiting for upload and uploads waiting for their fence.
+  std::deque<std::shared_ptr<texture>> decode_;
+  std::deque<item> upload_;
+  std::vector<item> complete_;
+
+  std::size_t buffers_ = 0;
+  std::vector<std::thread> workers_;
+  std::thread uploader_;
+};
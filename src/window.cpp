@@ -1,14 +1,19 @@
 #include "window.h"
 #include <config.h>
+#include <scheduler.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
 #ifdef WIN32
 #include <windows.h>
 
 class window::impl {
 public:
-  impl(window* window, int argc, char* argv[]) noexcept : window_(window) {
+  impl(window* window, int argc, char* argv[]) noexcept : window_(window), options_(argc, argv) {
     WNDCLASSEX wc = {};
     wc.cbSize = sizeof(wc);
     wc.style = CS_OWNDC;
@@ -37,7 +42,11 @@ public:
   int run() noexcept {
     const auto es = WS_EX_APPWINDOW;
     const auto ws = WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX;
-    if (!CreateWindowEx(es, name(), name(), ws, CW_USEDEFAULT, CW_USEDEFAULT, 800, 600, nullptr, nullptr, hinstance_, this)) {
+    RECT rc = { 0, 0, options_.cx, options_.cy };
+    AdjustWindowRectEx(&rc, ws, FALSE, es);
+    const auto cx = rc.right - rc.left;
+    const auto cy = rc.bottom - rc.top;
+    if (!CreateWindowEx(es, name(), name(), ws, CW_USEDEFAULT, CW_USEDEFAULT, cx, cy, nullptr, nullptr, hinstance_, this)) {
       error("Could not create main application window.");
     }
     MSG msg = {};
@@ -49,7 +58,8 @@ public:
   }
 
   void show(bool show) noexcept {
-    ShowWindow(hwnd_, show ? SW_SHOW : SW_HIDE);
+    // Called from the render thread, which must not block on the message loop.
+    ShowWindowAsync(hwnd_, show ? SW_SHOW : SW_HIDE);
   }
 
   void error(const char* msg) noexcept {
@@ -100,13 +110,17 @@ public:
     cx_ = static_cast<GLsizei>(std::max(1L, rc.right - rc.left));
     cy_ = static_cast<GLsizei>(std::max(1L, rc.bottom - rc.top));
 
-    // Notify client.
-    window_->on_create(cx_, cy_, dpi_);
+    // Start render thread, which creates the OpenGL ES context and notifies the client.
+    running_ = true;
+    thread_ = std::thread([this]() { render(); });
   }
 
   void on_destroy() {
-    // Notify client.
-    window_->on_destroy();
+    // Stop render thread, which destroys the OpenGL ES context and notifies the client.
+    running_ = false;
+    if (thread_.joinable()) {
+      thread_.join();
+    }
 
     // Release display handle.
     ReleaseDC(hwnd_, hdc_);
@@ -127,33 +141,35 @@ public:
   }
 
   void on_paint() {
-    if (!exception_) {
-      try {
-        window_->on_render();
-      }
-      catch (...) {
-        exception_ = std::current_exception();
-        PostMessage(hwnd_, WM_CLOSE, 0, 0);
-      }
-    } else {
-      PAINTSTRUCT ps = {};
-      auto hdc = BeginPaint(hwnd_, &ps);
-      RECT rc = { 0, 0, cx_, cy_ };
-      FillRect(hdc, &rc, reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1));
-      EndPaint(hwnd_, &ps);
+    // Frames are presented by the render thread.
+    if (!failed_) {
+      ValidateRect(hwnd_, nullptr);
+      return;
     }
+    PAINTSTRUCT ps = {};
+    auto hdc = BeginPaint(hwnd_, &ps);
+    RECT rc = {};
+    GetClientRect(hwnd_, &rc);
+    FillRect(hdc, &rc, reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1));
+    EndPaint(hwnd_, &ps);
   }
 
   void on_size(int cx, int cy) {
+    std::lock_guard<std::mutex> lock(mutex_);
     cx_ = static_cast<GLsizei>(std::max(1, cx));
     cy_ = static_cast<GLsizei>(std::max(1, cy));
-    window_->on_resize(cx_, cy_, dpi_);
+    resized_ = true;
   }
 
   void on_dpi(int dpi, LPCRECT rc) {
     SetWindowPos(hwnd_, nullptr, rc->left, rc->top, rc->right - rc->left, rc->bottom - rc->top, SWP_NOZORDER | SWP_NOACTIVATE);
+    std::lock_guard<std::mutex> lock(mutex_);
     dpi_ = static_cast<GLint>(std::max(1, dpi));
-    window_->on_resize(cx_, cy_, dpi_);
+    resized_ = true;
+  }
+
+  const options& settings() const noexcept {
+    return options_;
   }
 
   EGLNativeWindowType native_window() const {
@@ -169,6 +185,60 @@ public:
   }
 
 private:
+  // Render loop. Resize, move and modal loops on the window thread only forward the new size.
+  void render() noexcept {
+    auto created = false;
+    try {
+      GLsizei cx = 1;
+      GLsizei cy = 1;
+      GLint dpi = 96;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cx = cx_;
+        cy = cy_;
+        dpi = dpi_;
+        resized_ = false;
+      }
+      window_->on_create(cx, cy, dpi);
+      created = true;
+
+      scheduler scheduler(options_.pacing, options_.fps);
+      while (running_) {
+        auto resized = false;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (resized_) {
+            cx = cx_;
+            cy = cy_;
+            dpi = dpi_;
+            resized_ = false;
+            resized = true;
+          }
+        }
+        if (resized) {
+          window_->on_resize(cx, cy, dpi);
+        }
+        window_->on_render();
+        scheduler.wait();
+      }
+    }
+    catch (...) {
+      exception_ = std::current_exception();
+      failed_ = true;
+      PostMessage(hwnd_, WM_CLOSE, 0, 0);
+    }
+    if (created) {
+      try {
+        window_->on_destroy();
+      }
+      catch (...) {
+        if (!exception_) {
+          exception_ = std::current_exception();
+        }
+      }
+    }
+  }
+
   LRESULT handle(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) noexcept {
     try {
       switch (msg) {
@@ -206,17 +276,101 @@ private:
   }
 
   window* window_ = nullptr;
+  options options_;
   HINSTANCE hinstance_ = GetModuleHandle(nullptr);
   HWND hwnd_ = {};
   HDC hdc_ = {};
 
+  // Window state shared with the render thread.
+  std::mutex mutex_;
   GLsizei cx_ = 1;
   GLsizei cy_ = 1;
   GLint dpi_ = 96;
+  bool resized_ = false;
 
+  std::thread thread_;
+  std::atomic_bool running_ = false;
+  std::atomic_bool failed_ = false;
   std::exception_ptr exception_;
 };
 
+#else
+#include <csignal>
+#include <cstdio>
+
+// Headless implementation without a native window or message pump.
+// The context renders into a pbuffer or surfaceless context and the loop drives
+// create, resize, render and destroy back to back until the frame limit is reached.
+class window::impl {
+public:
+  impl(window* window, int argc, char* argv[]) noexcept : window_(window), options_(argc, argv) {}
+
+  int run() noexcept {
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    auto created = false;
+    auto result = 0;
+    try {
+      window_->on_create(options_.cx, options_.cy, dpi_);
+      created = true;
+      scheduler scheduler(options_.pacing, options_.fps);
+      auto resize = options_.resize.begin();
+      while (!stopped_ && (!options_.frames || scheduler.frame() < options_.frames)) {
+        // Apply the scheduled size changes like a window manager would between frames.
+        for (; resize != options_.resize.end() && resize->frame <= scheduler.frame(); ++resize) {
+          window_->on_resize(resize->cx, resize->cy, dpi_);
+        }
+        window_->on_render();
+        scheduler.wait();
+      }
+    }
+    catch (const std::exception& e) {
+      error(e.what());
+      result = 1;
+    }
+    if (created) {
+      try {
+        window_->on_destroy();
+      }
+      catch (const std::exception& e) {
+        error(e.what());
+        result = 1;
+      }
+    }
+    return result;
+  }
+
+  void show(bool show) noexcept {
+  }
+
+  void error(const char* msg) noexcept {
+    std::fprintf(stderr, "%s: %s\n", PROJECT, msg);
+  }
+
+  const options& settings() const noexcept {
+    return options_;
+  }
+
+  EGLNativeWindowType native_window() const {
+    return {};
+  }
+
+  EGLNativeDisplayType nateive_display() const {
+    return EGL_DEFAULT_DISPLAY;
+  }
+
+private:
+  static void stop(int signal) noexcept {
+    stopped_ = true;
+  }
+
+  window* window_ = nullptr;
+  options options_;
+  GLint dpi_ = 96;
+
+  static inline std::atomic_bool stopped_ = false;
+};
+
 #endif
 
 window::window(int argc, char* argv[]) : impl_(std::make_unique<impl>(this, argc, argv)) {
@@ -232,6 +386,10 @@ void window::show(bool show) noexcept {
   impl_->show(show);
 }
 
+const options& window::settings() const noexcept {
+  return impl_->settings();
+}
+
 EGLNativeWindowType window::native_window() const {
   return impl_->native_window();
 }
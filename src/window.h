@@ -4,6 +4,7 @@
 #include <EGL/eglplatform.h>
 #include <GLES3/gl3.h>
 #include <GLES2/gl2ext.h>
+#include <options.h>
 #include <memory>
 
 class window {
@@ -16,6 +17,8 @@ public:
   int run() noexcept;
   void show(bool show) noexcept;
 
+  const options& settings() const noexcept;
+
   EGLNativeWindowType native_window() const;
   EGLNativeDisplayType nateive_display() const;
 